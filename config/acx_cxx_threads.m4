@@ -0,0 +1,50 @@
+# Check for the compiler/linker flags needed to use C++11 threads.
+#
+# Tries to compile and link a small program using std::thread, first without
+# any additional flags and then with -pthread. If a working flag is found, it
+# is appended to both CXXFLAGS and LDFLAGS.
+#
+# Fails if no working set of flags can be found.
+AC_DEFUN([ACX_CXX_THREADS],
+[
+  AC_MSG_CHECKING([for the flags needed to use std::thread])
+  acx_cxx_threads=no
+
+  for acx_flag in "" "-pthread"; do
+    # store the existing CXXFLAGS and LDFLAGS
+    my_CXXFLAGS=$CXXFLAGS
+    my_LDFLAGS=$LDFLAGS
+
+    CXXFLAGS="$CXXFLAGS $acx_flag"
+    LDFLAGS="$LDFLAGS $acx_flag"
+
+    AC_LINK_IFELSE(
+      [AC_LANG_PROGRAM([[#include <thread>]],
+        [[int x = 0;
+          std::thread t([&x] () { x = 1; });
+          t.join();
+          return x == 1 ? 0 : 1;]])],
+      [acx_cxx_threads=yes])
+
+    # revert the CXXFLAGS and LDFLAGS
+    CXXFLAGS=$my_CXXFLAGS
+    LDFLAGS=$my_LDFLAGS
+
+    if test x"$acx_cxx_threads" = xyes; then
+      break
+    fi
+  done
+
+  if test x"$acx_cxx_threads" = xyes; then
+    if test x"$acx_flag" = x; then
+      AC_MSG_RESULT([none needed])
+    else
+      AC_MSG_RESULT([$acx_flag])
+      CXXFLAGS="$CXXFLAGS $acx_flag"
+      LDFLAGS="$LDFLAGS $acx_flag"
+    fi
+  else
+    AC_MSG_RESULT([no])
+    AC_MSG_ERROR([Unable to compile and link a program using std::thread.])
+  fi
+])
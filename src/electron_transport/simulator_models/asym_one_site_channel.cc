@@ -61,14 +61,6 @@ double AsymOneSiteChannel::ECurrent(const std::valarray<double> &params) const
 		- atan(2. * (ef-eps-(0.5+a)*V) / (gammal + gammar)));
 }
 
-double AsymOneSiteChannel::StaticG(const std::valarray<double> &params) const
-{
-	// unpack the model parameters
-	const double &V = params[Index_V];
-
-	return ECurrent(params) / (TransportJunction::qc * V);
-}
-
 double AsymOneSiteChannel::ZeroBiasG(const std::valarray<double> &params) const
 {
 	// unpack the model parameters
@@ -50,7 +50,7 @@ class AsymOneSiteChannel : public Channel,
 	public ElectricCurrent,
 	public ZeroBiasConductance,
 	public DifferentialConductance,
-	public StaticConductance
+	public CurrentStaticConductance<AsymOneSiteChannel>
 {
 public:
 	/// Container index for the Fermi energy.
@@ -95,7 +95,6 @@ public:
 	virtual double ZeroBiasG(const std::valarray<double> &params) const
 		override;
 	virtual double DiffG(const std::valarray<double> &params) const override;
-	virtual double StaticG(const std::valarray<double> &params) const override;
 };
 
 } // namespace molstat::transport
@@ -49,20 +49,24 @@ double AsymTwoSiteChannel::transmission(const double e, const double V,
 		(temp*temp + 4.*(gammal+gammar)*(gammal+gammar)*(e-eps)*(e-eps));
 }
 
-double AsymTwoSiteChannel::current_integral(const double z,
-	const double eps, const double gammal, const double gammar,
-	const double beta)
+AsymTwoSiteChannel::CurrentIntegral::CurrentIntegral(const double eps_,
+	const double gammal, const double gammar, const double beta)
+	: eps(eps_),
+	  prefactor(sqrt(128.)*gammal*gammar*beta*beta / (gammal + gammar))
 {
-	std::complex<double> bgg = sqrt(std::complex<double>((gammal-gammar)*(gammal-gammar)
+	bgg = sqrt(std::complex<double>((gammal-gammar)*(gammal-gammar)
 		- 16.*beta*beta, 0.));
 
-	std::complex<double> denom1 = sqrt(-8.*beta*beta + gammal*gammal + gammar*gammar
+	denom1 = sqrt(-8.*beta*beta + gammal*gammal + gammar*gammar
 		- (gammal + gammar) * bgg);
 
-	std::complex<double> denom2 = sqrt(-8.*beta*beta + gammal*gammal + gammar*gammar
+	denom2 = sqrt(-8.*beta*beta + gammal*gammal + gammar*gammar
 		+ (gammal + gammar) * bgg);
+}
 
-	return sqrt(128.)*gammal*gammar*beta*beta / (gammal + gammar) * real(
+double AsymTwoSiteChannel::CurrentIntegral::operator()(const double z) const
+{
+	return prefactor * real(
 		(atan(sqrt(8.)*(z-eps) / denom1) / denom1 -
 		 atan(sqrt(8.)*(z-eps) / denom2) / denom2) / bgg
 		);
@@ -78,17 +82,11 @@ double AsymTwoSiteChannel::ECurrent(const std::valarray<double> &params) const
 	const double &gammar = params[Index_gammaR];
 	const double &beta = params[Index_beta];
 
-	return TransportJunction::qc *
-		(current_integral(ef + 0.5*V, eps, gammal, gammar, beta) -
-		 current_integral(ef - 0.5*V, eps, gammal, gammar, beta));
-}
+	// the complex square roots are shared by both limits
+	const CurrentIntegral current_integral(eps, gammal, gammar, beta);
 
-double AsymTwoSiteChannel::StaticG(const std::valarray<double> &params) const
-{
-	// unpack the parameters
-	const double &V = params[Index_V];
-
-	return ECurrent(params) / (TransportJunction::qc * V);
+	return TransportJunction::qc *
+		(current_integral(ef + 0.5*V) - current_integral(ef - 0.5*V));
 }
 
 double AsymTwoSiteChannel::ZeroBiasG(const std::valarray<double> &params) const
@@ -15,6 +15,7 @@
 #ifndef __asym_two_site_channel_h__
 #define __asym_two_site_channel_h__
 
+#include <complex>
 #include "observables.h"
 #include "junction.h"
 
@@ -52,24 +53,57 @@ class AsymTwoSiteChannel : public Channel,
 	public ElectricCurrent,
 	public ZeroBiasConductance,
 	public DifferentialConductance,
-	public StaticConductance
+	public CurrentStaticConductance<AsymTwoSiteChannel>
 {
 private:
 	/**
-	 * \brief Calculates the antiderivative needed for the electric current
-	 *    (fixed values of the model parameters).
+	 * \brief The antiderivative needed for the electric current (fixed values
+	 *    of the model parameters).
 	 *
-	 * \param[in] z The limit of integration.
-	 * \param[in] eps The channel energy, \f$\varepsilon\f$.
-	 * \param[in] gammal The left channel-lead coupling,
-	 *    \f$\Gamma_\mathrm{L}\f$.
-	 * \param[in] gammar The right channel-lead coupling,
-	 *    \f$\Gamma_\mathrm{R}\f$.
-	 * \param[in] beta The site-site coupling, \f$\beta\f$.
-	 * \return The antiderivative needed for the static conductance.
+	 * The complex square roots do not depend on the limit of integration; they
+	 * are calculated once, when the antiderivative is constructed, and shared
+	 * by both limits.
 	 */
-	static double current_integral(const double z, const double eps,
-		const double gammal, const double gammar, const double beta);
+	class CurrentIntegral
+	{
+	private:
+		/// The channel energy, \f$\varepsilon\f$.
+		double eps;
+
+		/// The real prefactor.
+		double prefactor;
+
+		/// \f$\sqrt{(\Gamma_\mathrm{L} - \Gamma_\mathrm{R})^2 - 16\beta^2}\f$.
+		std::complex<double> bgg;
+
+		/// The first square root in the denominators.
+		std::complex<double> denom1;
+
+		/// The second square root in the denominators.
+		std::complex<double> denom2;
+
+	public:
+		/**
+		 * \brief Constructor.
+		 *
+		 * \param[in] eps_ The channel energy, \f$\varepsilon\f$.
+		 * \param[in] gammal The left channel-lead coupling,
+		 *    \f$\Gamma_\mathrm{L}\f$.
+		 * \param[in] gammar The right channel-lead coupling,
+		 *    \f$\Gamma_\mathrm{R}\f$.
+		 * \param[in] beta The site-site coupling, \f$\beta\f$.
+		 */
+		CurrentIntegral(const double eps_, const double gammal,
+			const double gammar, const double beta);
+
+		/**
+		 * \brief Evaluates the antiderivative.
+		 *
+		 * \param[in] z The limit of integration.
+		 * \return The antiderivative needed for the static conductance.
+		 */
+		double operator()(const double z) const;
+	};
 
 public:
 	/// Container index for the Fermi energy.
@@ -113,7 +147,6 @@ public:
 	virtual double ECurrent(const std::valarray<double> &params) const override;
 	virtual double ZeroBiasG(const std::valarray<double> &params) const
 		override;
-	virtual double StaticG(const std::valarray<double> &params) const override;
 	virtual double DiffG(const std::valarray<double> &params) const override;
 };
 
@@ -52,6 +52,44 @@ TransportJunction::TransportJunction() :
 		std::plus<double>()
 	)
 {
+	using namespace std;
+
+	// the thermopower and displacement depend on the submodels in ways that
+	// do not fit CompositeObservable. bind them to the submodels when the
+	// ObservableFunction is requested, and remove the kernels so that
+	// molstat::SimulationPlan uses the bound functions.
+	compatible_observables[GetObservableIndex<ZeroBiasThermopower>()] =
+		[] (shared_ptr<const SimulateModel> model) -> ObservableFunction
+		{
+			shared_ptr<const TransportJunction> junction =
+				dynamic_pointer_cast<const TransportJunction>(model);
+			if(junction == nullptr)
+				throw IncompatibleObservable();
+
+			return junction->bindZeroBiasS(model);
+		};
+	observable_kernels.erase(GetObservableIndex<ZeroBiasThermopower>());
+
+	compatible_observables[GetObservableIndex<Displacement>()] =
+		[] (shared_ptr<const SimulateModel> model) -> ObservableFunction
+		{
+			shared_ptr<const TransportJunction> junction =
+				dynamic_pointer_cast<const TransportJunction>(model);
+			if(junction == nullptr)
+				throw IncompatibleObservable();
+
+			return junction->bindDispW(model);
+		};
+	observable_kernels.erase(GetObservableIndex<Displacement>());
+
+	// the displacement is the rectangular barrier's. this lets
+	// molstat::SimulationPlan use the barrier's kernel, which is fused with its
+	// zero-bias conductance.
+	forwarded_observables[GetObservableIndex<Displacement>()] =
+		[] (const SimulateModel &model) -> bool
+		{
+			return dynamic_cast<const RectangularBarrier *>(&model) != nullptr;
+		};
 }
 /// \endcond
 
@@ -61,54 +99,119 @@ double TransportJunction::AppBias(const std::valarray<double> &params) const
 }
 
 double TransportJunction::ZeroBiasS(const std::valarray<double> &params) const
+{
+	return bindZeroBiasS(nullptr)(params);
+}
+
+double TransportJunction::DispW(const std::valarray<double> &params) const
+{
+	return bindDispW(nullptr)(params);
+}
+
+ObservableFunction TransportJunction::bindZeroBiasS(
+	std::shared_ptr<const SimulateModel> owner) const
 {
 	const ObservableIndex zbg { GetObservableIndex<ZeroBiasConductance>() };
 	const ObservableIndex s { GetObservableIndex<ZeroBiasThermopower>() };
 
-	// parse the parameters into submodels
-	const SubmodelParameters subparams{ routeSubmodelParameters(params) };
+	// the observable functions for a channel
+	struct ChannelFunctions
+	{
+		SubmodelLayout layout;
+		ObservableFunction g, s;
+	};
 
-	// the composite thermopower is
-	// S = sum_j (g_j S_j) / sum_k (g_k),
-	// where g_j is the zero-bias conductance and s_j is the Seebeck coefficient
-	// for the channel
-	double sumgs { 0. }, sumg{ 0. };
+	std::vector<ChannelFunctions> channels;
+	channels.reserve(submodels.size());
 
 	// go through each submodel
-	for(const auto submodel : subparams) {
-		// submodel.first is a pointer to the submodel
-		// submodel.second is the parameters to pass to it
-
-		// getObservableFunction will throw an exception if the submodel is
-		// incompatible with the specified observable
-		const double gj =
-			submodel.first->getObservableFunction(zbg)(submodel.second);
-		const double sj =
-			submodel.first->getObservableFunction(s)(submodel.second);
-
-		sumg += gj;
-		sumgs += gj * sj;
+	try
+	{
+		for(std::size_t j = 0; j < submodels.size(); ++j)
+		{
+			// getObservableFunction will throw an exception if the submodel is
+			// incompatible with the specified observable
+			channels.push_back({ layout[j],
+				submodels[j]->getObservableFunction(zbg),
+				submodels[j]->getObservableFunction(s) });
+		}
+	}
+	catch(const IncompatibleObservable &e)
+	{
+		// defer the exception until the observable is actually calculated
+		const std::string what{ e.what() };
+		return [what] (const std::valarray<double> &) -> double
+			{
+				throw IncompatibleObservable(what);
+			};
 	}
 
-	return sumgs / sumg;
+	// owner (if not null) keeps this junction alive
+	return [this, owner, channels] (const std::valarray<double> &params)
+			-> double
+		{
+			// reuse this thread's buffers for the submodel parameters
+			SubmodelScratch scratch(channels.size());
+
+			// the composite thermopower is
+			// S = sum_j (g_j S_j) / sum_k (g_k),
+			// where g_j is the zero-bias conductance and s_j is the Seebeck
+			// coefficient for the channel
+			double sumgs { 0. }, sumg{ 0. };
+
+			for(std::size_t j = 0; j < channels.size(); ++j)
+			{
+				// route the parameters to the submodel
+				std::valarray<double> &subparams = scratch.get(j,
+					num_composite_parameters + channels[j].layout.length);
+				getSubmodelParameters(params, channels[j].layout, subparams);
+
+				const double gj = channels[j].g(subparams);
+				const double sj = channels[j].s(subparams);
+
+				sumg += gj;
+				sumgs += gj * sj;
+			}
+
+			return sumgs / sumg;
+		};
 }
 
-double TransportJunction::DispW(const std::valarray<double> &params) const
+ObservableFunction TransportJunction::bindDispW(
+	std::shared_ptr<const SimulateModel> owner) const
 {
 	// the displacement observable requires one channel to be a
 	// rectangular barrier. search through the submodels for it.
-	// if not found, throw an exception.
-
-	for(const auto model : submodels)
+	for(std::size_t j = 0; j < submodels.size(); ++j)
 	{
-		const std::shared_ptr<RectangularBarrier> rbp =
-			std::dynamic_pointer_cast<RectangularBarrier>(model.first);
+		const std::shared_ptr<const RectangularBarrier> rbp =
+			std::dynamic_pointer_cast<const RectangularBarrier>(submodels[j]);
+
 		if(rbp != nullptr)
-			return rbp->DispW(params);
+		{
+			const SubmodelLayout sub{ layout[j] };
+
+			return [this, owner, rbp, sub] (const std::valarray<double> &params)
+					-> double
+				{
+					// route the parameters to the barrier
+					SubmodelScratch scratch(1);
+					std::valarray<double> &subparams =
+						scratch.get(0, num_composite_parameters + sub.length);
+					getSubmodelParameters(params, sub, subparams);
+
+					return rbp->DispW(subparams);
+				};
+		}
 	}
 
-	throw IncompatibleObservable(
-		"The displacement observable requires a rectangular barrier channel.");
+	// if not found, the function throws an exception.
+	return [] (const std::valarray<double> &) -> double
+		{
+			throw IncompatibleObservable(
+				"The displacement observable requires a rectangular barrier "
+				"channel.");
+		};
 }
 
 } // namespace molstat::transport
@@ -56,10 +56,46 @@ public:
 protected:
 	virtual std::vector<std::string> get_names() const override;
 
+	/**
+	 * \brief Binds the thermopower calculation to the submodels.
+	 *
+	 * The zero-bias conductance and thermopower functions of each channel are
+	 * obtained once, instead of every time the thermopower is calculated.
+	 *
+	 * The returned function throws molstat::IncompatibleObservable (when
+	 * called) if any channel is incompatible with either observable.
+	 *
+	 * \param[in] owner Pointer that keeps the junction alive for the life of
+	 *    the returned function; may be `nullptr` if the caller guarantees the
+	 *    lifetime.
+	 * \return The function that calculates the thermopower.
+	 */
+	ObservableFunction bindZeroBiasS(std::shared_ptr<const SimulateModel> owner)
+		const;
+
+	/**
+	 * \brief Binds the displacement calculation to the rectangular barrier
+	 *    channel.
+	 *
+	 * The returned function throws molstat::IncompatibleObservable (when
+	 * called) if no channel is a rectangular barrier.
+	 *
+	 * \param[in] owner Pointer that keeps the junction alive for the life of
+	 *    the returned function; may be `nullptr` if the caller guarantees the
+	 *    lifetime.
+	 * \return The function that calculates the displacement.
+	 */
+	ObservableFunction bindDispW(std::shared_ptr<const SimulateModel> owner)
+		const;
+
 public:
 	/**
 	 * \brief Constructor that tells the MolStat framework to add conductances
 	 *    from the channels (submodels).
+	 *
+	 * The thermopower and displacement observables are also set up to bind
+	 * to the channels when their molstat::ObservableFunction is obtained
+	 * (e.g., when the observable is set on a molstat::Simulator).
 	 */
 	TransportJunction();
 
@@ -68,6 +104,56 @@ public:
 	virtual double DispW(const std::valarray<double> &params) const override;
 };
 
+/**
+ * \brief Base class for a channel whose static conductance is its electric
+ *    current divided by the bias.
+ *
+ * The channel derives from `CurrentStaticConductance<T>` instead of
+ * molstat::transport::StaticConductance and only implements the electric
+ * current. The static conductance, \f$G_\mathrm{s}(V) = I(V)/(q_c V)\f$, is
+ * provided, as is a fused calculation (molstat::FusedObservable) of both
+ * observables that calculates the current once.
+ *
+ * \tparam T The channel class. `T` must derive from
+ *    molstat::transport::ElectricCurrent.
+ */
+template<typename T>
+class CurrentStaticConductance : public StaticConductance,
+	public FusedObservable<T, ElectricCurrent, StaticConductance>
+{
+private:
+	/**
+	 * \brief Calculates the electric current and static conductance together.
+	 *
+	 * \param[in] params A set of model parameters.
+	 * \param[out] obs The electric current (`obs[0]`) and static conductance
+	 *    (`obs[1]`).
+	 */
+	void ECurrentStaticG(const std::valarray<double> &params, double *obs)
+		const
+	{
+		obs[0] = static_cast<const T *>(this)->T::ECurrent(params);
+		obs[1] = obs[0] /
+			(TransportJunction::qc * params[TransportJunction::Index_V]);
+	}
+
+public:
+	/// Constructor that registers the fused calculation.
+	CurrentStaticConductance()
+		: FusedObservable<T, ElectricCurrent, StaticConductance>(
+			&CurrentStaticConductance<T>::ECurrentStaticG)
+	{
+	}
+
+	virtual ~CurrentStaticConductance() = default;
+
+	virtual double StaticG(const std::valarray<double> &params) const override
+	{
+		return static_cast<const T *>(this)->T::ECurrent(params) /
+			(TransportJunction::qc * params[TransportJunction::Index_V]);
+	}
+};
+
 } // namespace molstat::transport
 } // namespace molstat
 
@@ -27,6 +27,15 @@ const std::size_t RectangularBarrier::Index_V = TransportJunction::Index_V;
 const std::size_t RectangularBarrier::Index_h = 2;
 const std::size_t RectangularBarrier::Index_w = 3;
 
+/// \cond
+RectangularBarrier::RectangularBarrier() :
+	FusedObservable<RectangularBarrier, ZeroBiasConductance, Displacement>(
+		&RectangularBarrier::ZeroBiasGDispW
+	)
+{
+}
+/// \endcond
+
 std::vector<std::string> RectangularBarrier::get_names() const
 {
 	std::vector<std::string> ret(2);
@@ -74,6 +83,18 @@ double RectangularBarrier::DispW(const std::valarray<double> &params) const
 	return w;
 }
 
+void RectangularBarrier::ZeroBiasGDispW(const std::valarray<double> &params,
+	double *obs) const
+{
+	// unpack the parameters
+	const double &ef = params[Index_EF];
+	const double &h = params[Index_h];
+	const double &w = params[Index_w];
+
+	obs[0] = transmission(ef, h, w);
+	obs[1] = w;
+}
+
 #if HAVE_GSL
 double RectangularBarrier::gsl_StaticG_integrand(double E, void *p) 
 {
@@ -57,7 +57,9 @@ class RectangularBarrier : public Channel,
 	#if HAVE_GSL
 	public StaticConductance,
 	#endif
-	public Displacement
+	public Displacement,
+	public FusedObservable<RectangularBarrier, ZeroBiasConductance,
+		Displacement>
 {
 public:
 	/// Container index for the Fermi energy.
@@ -76,6 +78,12 @@ protected:
 	virtual std::vector<std::string> get_names() const override;
 
 public:
+	/**
+	 * \brief Constructor that registers the fused calculation of the zero-bias
+	 *    conductance and displacement.
+	 */
+	RectangularBarrier();
+
 	virtual ~RectangularBarrier() = default;
 
 	/**
@@ -92,6 +100,17 @@ public:
 	virtual double ZeroBiasS(const std::valarray<double> &params) const override;
 	virtual double DispW(const std::valarray<double> &params) const override;
 
+	/**
+	 * \brief Calculates the zero-bias conductance and displacement together,
+	 *    as needed for a conductance-displacement histogram.
+	 *
+	 * \param[in] params A set of model parameters.
+	 * \param[out] obs The zero-bias conductance (`obs[0]`) and displacement
+	 *    (`obs[1]`).
+	 */
+	void ZeroBiasGDispW(const std::valarray<double> &params, double *obs)
+		const;
+
 	#if HAVE_GSL
 protected:
 	/// Struct for using GSL to evaluate the static conductance integral.
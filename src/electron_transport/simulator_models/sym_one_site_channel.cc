@@ -79,14 +79,6 @@ double SymOneSiteChannel::ECurrent(const std::valarray<double> & params) const
 		(atan((ef-eps+(0.5-a)*V) / gamma) - atan((ef-eps-(0.5+a)*V) / gamma));
 }
 
-double SymOneSiteChannel::StaticG(const std::valarray<double> &params) const
-{
-	// unpack the parameters
-	const double &V = params[Index_V];
-	
-	return ECurrent(params) / (TransportJunction::qc * V);
-}
-
 double SymOneSiteChannel::ZeroBiasS(const std::valarray<double> &params) const
 {
 	// unpack the parameters
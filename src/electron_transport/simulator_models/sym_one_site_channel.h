@@ -53,7 +53,7 @@ class SymOneSiteChannel : public Channel,
 	public ElectricCurrent,
 	public ZeroBiasConductance,
 	public DifferentialConductance,
-	public StaticConductance,
+	public CurrentStaticConductance<SymOneSiteChannel>,
 	public ZeroBiasThermopower
 {
 public:
@@ -94,7 +94,6 @@ public:
 	virtual double ECurrent(const std::valarray<double> &params) const override;
 	virtual double ZeroBiasG(const std::valarray<double> &params) const override;
 	virtual double DiffG(const std::valarray<double> &params) const override;
-	virtual double StaticG(const std::valarray<double> &params) const override;
 	virtual double ZeroBiasS(const std::valarray<double> &params) const override;
 };
 
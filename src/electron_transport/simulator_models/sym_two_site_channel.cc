@@ -46,12 +46,16 @@ double SymTwoSiteChannel::transmission(const double e, const double V,
 		(temp*temp + 16.*gamma*gamma*(e-eps)*(e-eps));
 }
 
-double SymTwoSiteChannel::current_integral(const double z,
-	const double eps, const double gamma, const double beta)
+SymTwoSiteChannel::CurrentIntegral::CurrentIntegral(const double eps_,
+	const double gamma, const double beta)
+	: eps(eps_), prefactor(2.*beta*gamma / (4.*beta*beta + gamma*gamma)),
+	  factor(gamma, 2.*beta), scale(2.*beta, gamma)
+{
+}
+
+double SymTwoSiteChannel::CurrentIntegral::operator()(const double z) const
 {
-	return 2.*beta*gamma / (4.*beta*beta + gamma*gamma) *
-		real(std::complex<double>(gamma, 2.*beta)
-		* atanh(2.*(z-eps) / std::complex<double>(2.*beta, gamma)));
+	return prefactor * real(factor * atanh(2.*(z-eps) / scale));
 }
 
 double SymTwoSiteChannel::ECurrent(const std::valarray<double> &params) const
@@ -62,18 +66,12 @@ double SymTwoSiteChannel::ECurrent(const std::valarray<double> &params) const
 	const double &eps = params[Index_epsilon];
 	const double &gamma = params[Index_gamma];
 	const double &beta = params[Index_beta];
-	
-	return TransportJunction::qc *
-		(current_integral(ef + 0.5*V, eps, gamma, beta) -
-		 current_integral(ef - 0.5*V, eps, gamma, beta));
-}
 
-double SymTwoSiteChannel::StaticG(const std::valarray<double> &params) const
-{
-	// unpack the parameters
-	const double &V = params[Index_V];
-	
-	return ECurrent(params) / (TransportJunction::qc * V);
+	// both limits share the antiderivative's constants
+	const CurrentIntegral current_integral(eps, gamma, beta);
+
+	return TransportJunction::qc *
+		(current_integral(ef + 0.5*V) - current_integral(ef - 0.5*V));
 }
 
 double SymTwoSiteChannel::ZeroBiasG(const std::valarray<double> &params) const
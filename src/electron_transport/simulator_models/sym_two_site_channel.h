@@ -15,6 +15,7 @@
 #ifndef __sym_two_site_channel_h__
 #define __sym_two_site_channel_h__
 
+#include <complex>
 #include "observables.h"
 #include "junction.h"
 
@@ -54,22 +55,52 @@ class SymTwoSiteChannel : public Channel,
 	public ElectricCurrent,
 	public ZeroBiasConductance,
 	public DifferentialConductance,
-	public StaticConductance,
+	public CurrentStaticConductance<SymTwoSiteChannel>,
 	public ZeroBiasThermopower
 {
 private:
 	/**
-	 * \brief Calculates the antiderivative needed for the electric current
-	 *    (fixed values of the model parameters).
+	 * \brief The antiderivative needed for the electric current (fixed values
+	 *    of the model parameters).
 	 *
-	 * \param[in] z The limit of integration.
-	 * \param[in] eps The channel energy, epsilon.
-	 * \param[in] gamma The channel-lead coupling, gamma.
-	 * \param[in] beta The site-site coupling, beta.
-	 * \return The antiderivative needed for the static conductance.
+	 * The parts that do not depend on the limit of integration are calculated
+	 * once, when the antiderivative is constructed, and shared by both
+	 * limits.
 	 */
-	static double current_integral(const double z, const double eps,
-		const double gamma, const double beta);
+	class CurrentIntegral
+	{
+	private:
+		/// The channel energy, epsilon.
+		double eps;
+
+		/// The real prefactor.
+		double prefactor;
+
+		/// The complex factor multiplying the arctanh.
+		std::complex<double> factor;
+
+		/// The complex scale of the arctanh's argument.
+		std::complex<double> scale;
+
+	public:
+		/**
+		 * \brief Constructor.
+		 *
+		 * \param[in] eps_ The channel energy, epsilon.
+		 * \param[in] gamma The channel-lead coupling, gamma.
+		 * \param[in] beta The site-site coupling, beta.
+		 */
+		CurrentIntegral(const double eps_, const double gamma,
+			const double beta);
+
+		/**
+		 * \brief Evaluates the antiderivative.
+		 *
+		 * \param[in] z The limit of integration.
+		 * \return The antiderivative needed for the static conductance.
+		 */
+		double operator()(const double z) const;
+	};
 
 public:
 	/// Container index for the Fermi energy.
@@ -109,7 +140,6 @@ public:
 	virtual double ECurrent(const std::valarray<double> &params) const override;
 	virtual double ZeroBiasG(const std::valarray<double> &params) const override;
 	virtual double DiffG(const std::valarray<double> &params) const override;
-	virtual double StaticG(const std::valarray<double> &params) const override;
 	virtual double ZeroBiasS(const std::valarray<double> &params) const override;
 };
 
@@ -0,0 +1,126 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/benchmark-Engines.cc
+ * \brief Benchmark of the random number generators.
+ *
+ * \test For each generator of molstat::Engine, prints the number of random
+ *    numbers drawn per second (one at a time, and in blocks) and the number
+ *    of trials simulated per second for a composite junction with two
+ *    channels (in blocks with their own substreams, as in
+ *    `molstat-simulator`). The reproducibility of the substreams is tested
+ *    in random_engine.cc.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <general/random_distributions/lognormal.h>
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulator.h>
+#include <electron_transport/simulator_models/sym_one_site_channel.h>
+#include <electron_transport/simulator_models/asym_one_site_channel.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for the benchmark.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	using namespace molstat;
+	using namespace molstat::transport;
+	using clock = chrono::steady_clock;
+
+	constexpr size_t ndraws = 1 << 24;
+	constexpr size_t ntrials = 1 << 18;
+	constexpr size_t block_size = 1024;
+
+	// build a junction with two channels
+	shared_ptr<SimulateModel> channel1 =
+		SimulateModelFactory::makeFactory<SymOneSiteChannel>()
+		.setDistribution("epsilon", make_shared<NormalDistribution>(-3., 0.5))
+		.setDistribution("gamma", make_shared<LognormalDistribution>(-1., 0.3))
+		.setDistribution("a", make_shared<UniformDistribution>(-0.1, 0.1))
+		.getModel();
+
+	shared_ptr<SimulateModel> channel2 =
+		SimulateModelFactory::makeFactory<AsymOneSiteChannel>()
+		.setDistribution("epsilon", make_shared<NormalDistribution>(-4., 0.5))
+		.setDistribution("gammal", make_shared<LognormalDistribution>(-1., 0.3))
+		.setDistribution("gammar", make_shared<LognormalDistribution>(-1., 0.3))
+		.setDistribution("a", make_shared<UniformDistribution>(-0.1, 0.1))
+		.getModel();
+
+	shared_ptr<SimulateModel> junction =
+		SimulateModelFactory::makeFactory<TransportJunction>()
+		.setDistribution("ef", make_shared<UniformDistribution>(-0.5, 0.5))
+		.setDistribution("v", make_shared<UniformDistribution>(0.5, 1.5))
+		.addSubmodel(channel1)
+		.addSubmodel(channel2)
+		.getModel();
+
+	Simulator sim(junction);
+	sim.setObservable(0, GetObservableIndex<StaticConductance>());
+	sim.setObservable(1, GetObservableIndex<ElectricCurrent>());
+
+	vector<double> obs(2 * block_size);
+	vector<Engine::result_type> draws(sample_block);
+	unique_ptr<bool[]> produced{ new bool[block_size] };
+
+	cout << setw(14) << left << "Engine" << setw(16) << right << "draws/s" <<
+		setw(16) << "block draws/s" << setw(16) << "trials/s" << '\n';
+
+	for(EngineType type : { EngineType::Philox, EngineType::MT19937_64,
+		EngineType::Xoshiro256pp, EngineType::PCG64 })
+	{
+		Engine engine{ type, 1 };
+
+		// raw draws; the sum keeps the loop from being optimized away
+		Engine::result_type sum{ 0 };
+		const auto start1 = clock::now();
+		for(size_t k = 0; k < ndraws; ++k)
+			sum += engine();
+		const auto stop1 = clock::now();
+
+		// draws in blocks, as the distributions' sampleN functions use
+		const auto start3 = clock::now();
+		for(size_t k = 0; k < ndraws; k += sample_block)
+		{
+			engine.generate(draws.data(), sample_block);
+			sum += draws[0];
+		}
+		const auto stop3 = clock::now();
+
+		// full trials, in blocks with their own substreams
+		const auto start2 = clock::now();
+		for(size_t block = 0; block < ntrials / block_size; ++block)
+		{
+			engine.substream(block);
+			sim.simulateBatch(engine, block_size, obs.data(), produced.get());
+		}
+		const auto stop2 = clock::now();
+
+		const double t1 = chrono::duration<double>(stop1 - start1).count();
+		const double t2 = chrono::duration<double>(stop2 - start2).count();
+		const double t3 = chrono::duration<double>(stop3 - start3).count();
+
+		cout << setw(14) << left << engineName(type) << right << scientific <<
+			setprecision(3) << setw(16) << ndraws / t1 << setw(16) <<
+			ndraws / t3 << setw(16) << ntrials / t2 << "   (checksum " << hex << (sum & 0xFFFF) << dec <<
+			")\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/benchmark-SimulationPlan.cc
+ * \brief Benchmark of the flattened simulation plan for a composite junction.
+ *
+ * \test Compares the molstat::SimulationPlan used by molstat::Simulator with
+ *    calling the molstat::ObservableFunction of each observable for a
+ *    composite junction with two channels. The observables must be identical;
+ *    the time per trial for both methods is printed.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <valarray>
+#include <vector>
+
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulator.h>
+#include <electron_transport/simulator_models/sym_one_site_channel.h>
+#include <electron_transport/simulator_models/asym_one_site_channel.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for the benchmark.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	using namespace molstat;
+	using namespace molstat::transport;
+	using clock = chrono::steady_clock;
+
+	constexpr size_t ntrials = 200000;
+
+	// build a junction with two channels
+	shared_ptr<SimulateModel> channel1 =
+		SimulateModelFactory::makeFactory<SymOneSiteChannel>()
+		.setDistribution("epsilon", make_shared<NormalDistribution>(-3., 0.5))
+		.setDistribution("gamma", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("a", make_shared<UniformDistribution>(-0.1, 0.1))
+		.getModel();
+
+	shared_ptr<SimulateModel> channel2 =
+		SimulateModelFactory::makeFactory<AsymOneSiteChannel>()
+		.setDistribution("epsilon", make_shared<NormalDistribution>(-4., 0.5))
+		.setDistribution("gammal", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("gammar", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("a", make_shared<UniformDistribution>(-0.1, 0.1))
+		.getModel();
+
+	shared_ptr<SimulateModel> junction =
+		SimulateModelFactory::makeFactory<TransportJunction>()
+		.setDistribution("ef", make_shared<UniformDistribution>(-0.5, 0.5))
+		.setDistribution("v", make_shared<UniformDistribution>(0.5, 1.5))
+		.addSubmodel(channel1)
+		.addSubmodel(channel2)
+		.getModel();
+
+	const vector<ObservableIndex> obs{
+		GetObservableIndex<StaticConductance>(),
+		GetObservableIndex<ElectricCurrent>() };
+
+	// the current dispatch: an ObservableFunction per observable
+	vector<ObservableFunction> funcs;
+	for(const auto &o : obs)
+		funcs.emplace_back(junction->getObservableFunction(o));
+
+	// the parameters are generated in a batch, as in the simulation plan
+	const size_t nparams{ junction->get_num_parameters() };
+	vector<double> batch(nparams * ntrials);
+	Engine engine1{ 1 };
+
+	vector<double> ref(obs.size() * ntrials);
+	valarray<double> params(nparams);
+
+	const auto start1 = clock::now();
+	junction->fillParametersBatch(engine1, ntrials, batch.data());
+	for(size_t k = 0; k < ntrials; ++k)
+	{
+		for(size_t i = 0; i < nparams; ++i)
+			params[i] = batch[i*ntrials + k];
+		for(size_t j = 0; j < obs.size(); ++j)
+			ref[j*ntrials + k] = funcs[j](params);
+	}
+	const auto stop1 = clock::now();
+
+	// the simulation plan
+	Simulator sim(junction);
+	for(size_t j = 0; j < obs.size(); ++j)
+		sim.setObservable(j, obs[j]);
+
+	vector<double> plan(obs.size() * ntrials);
+	unique_ptr<bool[]> produced{ new bool[ntrials] };
+	Engine engine2{ 1 };
+
+	const auto start2 = clock::now();
+	sim.simulateBatch(engine2, ntrials, plan.data(), produced.get());
+	const auto stop2 = clock::now();
+
+	// the results must be identical
+	for(size_t k = 0; k < obs.size() * ntrials; ++k)
+		assert(ref[k] == plan[k]);
+
+	const double t1 = chrono::duration<double, nano>(stop1 - start1).count()
+		/ ntrials;
+	const double t2 = chrono::duration<double, nano>(stop2 - start2).count()
+		/ ntrials;
+
+	cout << "ObservableFunction dispatch: " << t1 << " ns/trial\n" <<
+		"SimulationPlan:              " << t2 << " ns/trial\n" <<
+		"Speedup: " << (t1 / t2) << endl;
+
+	return 0;
+}
@@ -0,0 +1,183 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file tests/simulate-FusedObservables.cc
+ * \brief Test suite for the fused observables of the transport channels.
+ *
+ * \test Checks that the observables calculated by fused kernels (through
+ *    molstat::SimulationPlan) are identical to those calculated one at a
+ *    time, for junctions of one- and two-site channels and for the
+ *    conductance-displacement pairing of a rectangular barrier.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <valarray>
+#include <vector>
+
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/uniform.h>
+#include <general/simulator_tools/simulator.h>
+#include <electron_transport/simulator_models/sym_one_site_channel.h>
+#include <electron_transport/simulator_models/asym_one_site_channel.h>
+#include <electron_transport/simulator_models/sym_two_site_channel.h>
+#include <electron_transport/simulator_models/asym_two_site_channel.h>
+#include <electron_transport/simulator_models/rectangular_barrier.h>
+
+using namespace std;
+using namespace molstat;
+using namespace molstat::transport;
+
+/**
+ * \brief Checks that two observables are identical (NaN matches NaN).
+ *
+ * \param[in] a The first value.
+ * \param[in] b The second value.
+ * \return True if the values are identical.
+ */
+static bool identical(const double a, const double b)
+{
+	return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+/**
+ * \brief Checks the fused observables of a model against the unfused ones.
+ *
+ * The observables are simulated together (so that the fused kernels are
+ * used). For the same model parameters, each observable is then calculated
+ * with its molstat::ObservableFunction and with a simulator that only
+ * calculates that observable.
+ *
+ * \param[in] model The model.
+ * \param[in] obs The observables.
+ */
+static void check_fused(const shared_ptr<SimulateModel> &model,
+	const vector<ObservableIndex> &obs)
+{
+	constexpr size_t n = 2000;
+
+	Simulator sim(model);
+	for(size_t j = 0; j < obs.size(); ++j)
+		sim.setObservable(j, obs[j]);
+
+	vector<double> fused(obs.size() * n);
+	vector<double> batch(sim.numParameters() * n);
+	unique_ptr<bool[]> produced{ new bool[n] };
+	Engine engine{ 5 };
+	sim.simulateBatch(engine, n, fused.data(), produced.get(), batch.data());
+
+	valarray<double> params(sim.numParameters());
+	for(size_t j = 0; j < obs.size(); ++j)
+	{
+		// one observable at a time; no fused kernel is used
+		Simulator single(model);
+		single.setObservable(0, obs[j]);
+
+		vector<double> unfused(n);
+		Engine engine1{ 5 };
+		single.simulateBatch(engine1, n, unfused.data(), produced.get());
+
+		const ObservableFunction func{ model->getObservableFunction(obs[j]) };
+
+		for(size_t k = 0; k < n; ++k)
+		{
+			for(size_t i = 0; i < params.size(); ++i)
+				params[i] = batch[i*n + k];
+
+			assert(identical(fused[j*n + k], unfused[k]));
+			assert(identical(fused[j*n + k], func(params)));
+		}
+	}
+}
+
+/**
+ * \brief Main function for testing the fused observables.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const ObservableIndex current{ GetObservableIndex<ElectricCurrent>() };
+	const ObservableIndex staticg{ GetObservableIndex<StaticConductance>() };
+	const ObservableIndex zerobiasg{
+		GetObservableIndex<ZeroBiasConductance>() };
+	const ObservableIndex diffg{
+		GetObservableIndex<DifferentialConductance>() };
+	const ObservableIndex disp{ GetObservableIndex<Displacement>() };
+
+	// the channels
+	shared_ptr<SimulateModel> symone =
+		SimulateModelFactory::makeFactory<SymOneSiteChannel>()
+		.setDistribution("epsilon", make_shared<NormalDistribution>(-3., 0.5))
+		.setDistribution("gamma", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("a", make_shared<UniformDistribution>(-0.1, 0.1))
+		.getModel();
+
+	shared_ptr<SimulateModel> asymone =
+		SimulateModelFactory::makeFactory<AsymOneSiteChannel>()
+		.setDistribution("epsilon", make_shared<NormalDistribution>(-4., 0.5))
+		.setDistribution("gammal", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("gammar", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("a", make_shared<UniformDistribution>(-0.1, 0.1))
+		.getModel();
+
+	shared_ptr<SimulateModel> symtwo =
+		SimulateModelFactory::makeFactory<SymTwoSiteChannel>()
+		.setDistribution("epsilon", make_shared<NormalDistribution>(-3., 0.5))
+		.setDistribution("gamma", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("beta", make_shared<UniformDistribution>(-0.6, -0.2))
+		.getModel();
+
+	shared_ptr<SimulateModel> asymtwo =
+		SimulateModelFactory::makeFactory<AsymTwoSiteChannel>()
+		.setDistribution("epsilon", make_shared<NormalDistribution>(-4., 0.5))
+		.setDistribution("gammal", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("gammar", make_shared<UniformDistribution>(0.2, 0.8))
+		.setDistribution("beta", make_shared<UniformDistribution>(-0.6, -0.2))
+		.getModel();
+
+	shared_ptr<SimulateModel> barrier =
+		SimulateModelFactory::makeFactory<RectangularBarrier>()
+		.setDistribution("height", make_shared<UniformDistribution>(4., 5.))
+		.setDistribution("width", make_shared<UniformDistribution>(0.1, 0.5))
+		.getModel();
+
+	// one-site channels
+	shared_ptr<SimulateModel> junction =
+		SimulateModelFactory::makeFactory<TransportJunction>()
+		.setDistribution("ef", make_shared<UniformDistribution>(-0.5, 0.5))
+		.setDistribution("v", make_shared<UniformDistribution>(0.5, 1.5))
+		.addSubmodel(symone)
+		.addSubmodel(asymone)
+		.getModel();
+	check_fused(junction, { staticg, current });
+	check_fused(junction, { current, diffg, staticg });
+
+	// two-site channels, where the current's complex square roots are shared
+	junction = SimulateModelFactory::makeFactory<TransportJunction>()
+		.setDistribution("ef", make_shared<UniformDistribution>(-0.5, 0.5))
+		.setDistribution("v", make_shared<UniformDistribution>(0.5, 1.5))
+		.addSubmodel(symtwo)
+		.addSubmodel(asymtwo)
+		.getModel();
+	check_fused(junction, { current, staticg });
+	check_fused(junction, { zerobiasg, staticg, current });
+
+	// conductance-displacement: the displacement is the barrier's width
+	junction = SimulateModelFactory::makeFactory<TransportJunction>()
+		.setDistribution("ef", make_shared<UniformDistribution>(0.5, 1.5))
+		.setDistribution("v", make_shared<UniformDistribution>(0.5, 1.5))
+		.addSubmodel(symone)
+		.addSubmodel(barrier)
+		.getModel();
+	check_fused(junction, { zerobiasg, disp });
+	check_fused(junction, { disp });
+
+	return 0;
+}
@@ -19,6 +19,7 @@
 #include <config.h>
 
 #include <electron_transport/simulator_models/rectangular_barrier.h>
+#include <electron_transport/simulator_models/sym_one_site_channel.h>
 
 using namespace std;
 
@@ -111,5 +112,35 @@ int main(int argc, char **argv)
 	assert(abs(2.16515e-1 - StaticG(params)) < thresh);
 	#endif
 
+	// the barrier need not be the first channel. make sure the displacement
+	// uses the barrier's parameters
+	shared_ptr<molstat::SimulateModel> other =
+		molstat::SimulateModelFactory::makeFactory
+			<molstat::transport::SymOneSiteChannel>()
+		.setDistribution("epsilon", nullptr)
+		.setDistribution("gamma", nullptr)
+		.setDistribution("a", nullptr)
+		.getModel();
+
+	shared_ptr<molstat::SimulateModel> junction2 =
+		molstat::SimulateModelFactory::makeFactory
+			<molstat::transport::TransportJunction>()
+		.setDistribution("ef", nullptr)
+		.setDistribution("v", nullptr)
+		.addSubmodel(other)
+		.addSubmodel(channel)
+		.getModel();
+
+	auto DispW2 = junction2->getObservableFunction(
+		type_index{ typeid(molstat::transport::Displacement) } );
+
+	const size_t offset{ other->get_num_parameters() };
+	valarray<double> params2(junction2->get_num_parameters());
+	params2[ChannelType::Index_EF] = 0.3;
+	params2[ChannelType::Index_V] = 0.;
+	params2[offset + ChannelType::Index_h] = 0.6;
+	params2[offset + ChannelType::Index_w] = 0.5;
+	assert(abs(0.5 - DispW2(params2)) < thresh);
+
 	return 0;
 }
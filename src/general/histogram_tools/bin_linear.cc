@@ -16,24 +16,14 @@
 namespace molstat
 {
 
-double BinLinear::mask(const double x) const
-{
-	return x;
-}
-
-double BinLinear::invmask(const double u) const
-{
-	return u;
-}
-
-double BinLinear::dmaskdx(const double x) const
+std::string BinLinear::info() const
 {
-	return 1.;
+	return std::to_string(nbins) + " linear bins";
 }
 
-std::string BinLinear::info() const
+std::string BinLinear::factoryString() const
 {
-	return std::to_string(nbins) + " linear bins";
+	return std::to_string(nbins) + " linear";
 }
 
 } // namespace molstat
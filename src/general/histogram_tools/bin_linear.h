@@ -24,10 +24,10 @@ namespace molstat
  *
  * \f$u = f(x) = x\f$. Trivially, \f$x = f^{-1}(u) = u\f$ and \f$f'(x) = 1\f$.
  */
-class BinLinear : public BinStyle
+class BinLinear : public BinStyleKernel<BinLinear>
 {
 public:
-	using BinStyle::BinStyle;
+	using BinStyleKernel<BinLinear>::BinStyleKernel;
 	virtual ~BinLinear() = default;
 
 	/**
@@ -36,7 +36,10 @@ public:
 	 * \param[in] x The unmasked data value.
 	 * \return The transformed (masked) data value.
 	 */
-	virtual double mask(const double x) const override;
+	double maskKernel(const double x) const
+	{
+		return x;
+	}
 
 	/**
 	 * \brief The inverse mask function, \f$x=f^{-1}(u) = u\f$.
@@ -44,7 +47,10 @@ public:
 	 * \param[in] u The transformed (masked) data value.
 	 * \return The unmasked data value.
 	 */
-	virtual double invmask(const double u) const override;
+	double invmaskKernel(const double u) const
+	{
+		return u;
+	}
 
 	/**
 	 * \brief The derivative \f$\mathrm{d}f / \mathrm{d}x = 1\f$.
@@ -52,9 +58,14 @@ public:
 	 * \param[in] x The unmasked value, \f$x\f$.
 	 * \return The derivative evaluated at \f$x\f$, \f$f'(x)\f$.
 	 */
-	virtual double dmaskdx(const double x) const override;
+	double dmaskdxKernel(const double x) const
+	{
+		return 1.;
+	}
 
 	virtual std::string info() const override;
+
+	virtual std::string factoryString() const override;
 };
 
 } // namespace molstat
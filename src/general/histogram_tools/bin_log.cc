@@ -13,34 +13,31 @@
 
 #include "bin_log.h"
 #include <cmath>
+#include <limits>
+#include <sstream>
 
 namespace molstat
 {
 
 BinLog::BinLog(const std::size_t nbin_, const double b_)
-	: BinStyle(nbin_), b(b_)
+	: BinStyleKernel<BinLog>(nbin_), b(b_), logb(log(b_))
 {
 }
 
-double BinLog::mask(const double x) const
+std::string BinLog::info() const
 {
-	return log(x) / log(b);
+	return std::to_string(nbins) + " logarithmic bins, base " +
+		std::to_string(b);
 }
 
-double BinLog::invmask(const double u) const
+std::string BinLog::factoryString() const
 {
-	return pow(b, u);
-}
+	// print the base with enough digits to recover it exactly
+	std::ostringstream ret;
+	ret.precision(std::numeric_limits<double>::max_digits10);
+	ret << nbins << " log " << b;
 
-double BinLog::dmaskdx(const double x) const
-{
-	return 1. / (x * log(b));
-}
-
-std::string BinLog::info() const
-{
-	return std::to_string(nbins) + " logarithmic bins, base " +
-		std::to_string(b);
+	return ret.str();
 }
 
 } // namespace molstat
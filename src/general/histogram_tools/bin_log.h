@@ -15,6 +15,7 @@
 #define __bin_log_h__
 
 #include "bin_style.h"
+#include <cmath>
 
 namespace molstat
 {
@@ -25,12 +26,15 @@ namespace molstat
  * \f$u = f(x) = \log_b(x)\f$. Then, \f$x = f^{-1}(u) = b^u\f$ and
  * \f$f'(x) = [x \ln(b)]^{-1} \f$.
  */
-class BinLog : public BinStyle
+class BinLog : public BinStyleKernel<BinLog>
 {
 protected:
 	/// The base of the logarithm.
 	const double b;
 
+	/// The natural logarithm of the base, \f$\ln(b)\f$.
+	const double logb;
+
 public:
 	BinLog() = delete;
 	virtual ~BinLog() = default;
@@ -49,7 +53,10 @@ public:
 	 * \param[in] x The unmasked data value.
 	 * \return The transformed (masked) data value.
 	 */
-	virtual double mask(const double x) const override;
+	double maskKernel(const double x) const
+	{
+		return std::log(x) / logb;
+	}
 
 	/**
 	 * \brief The inverse mask function, \f$x=f^{-1}(u) = b^u\f$.
@@ -57,7 +64,10 @@ public:
 	 * \param[in] u The transformed (masked) data value.
 	 * \return The unmasked data value.
 	 */
-	virtual double invmask(const double u) const override;
+	double invmaskKernel(const double u) const
+	{
+		return std::pow(b, u);
+	}
 
 	/**
 	 * \brief The derivative \f$\mathrm{d}f / \mathrm{d}x = [x \ln(b)]^{-1}\f$.
@@ -65,9 +75,14 @@ public:
 	 * \param[in] x The unmasked data value, \f$x\f$.
 	 * \return The derivative evaluated at \f$x\f$, \f$f'(x)\f$.
 	 */
-	virtual double dmaskdx(const double x) const override;
+	double dmaskdxKernel(const double x) const
+	{
+		return 1. / (x * logb);
+	}
 
 	virtual std::string info() const override;
+
+	virtual std::string factoryString() const override;
 };
 
 } // namespace molstat
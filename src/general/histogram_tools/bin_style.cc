@@ -26,6 +26,24 @@ BinStyle::BinStyle(const std::size_t nbins_)
 {
 }
 
+void BinStyle::mask(const double *x, double *u, const std::size_t n) const
+{
+	for(size_t k = 0; k < n; ++k)
+		u[k] = mask(x[k]);
+}
+
+void BinStyle::invmask(const double *u, double *x, const std::size_t n) const
+{
+	for(size_t k = 0; k < n; ++k)
+		x[k] = invmask(u[k]);
+}
+
+void BinStyle::dmaskdx(const double *x, double *d, const std::size_t n) const
+{
+	for(size_t k = 0; k < n; ++k)
+		d[k] = dmaskdx(x[k]);
+}
+
 std::unique_ptr<BinStyle> BinStyleFactory(TokenContainer &&tokens)
 {
 	unique_ptr<BinStyle> ret;
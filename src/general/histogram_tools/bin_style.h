@@ -37,6 +37,10 @@ namespace molstat
  * -# The inverse of the mask function: \f$ x = f^{-1}(u) \f$.
  * -# The derivative of the mask function: \f$ \mathrm{d}f / \mathrm{d}x \f$.
  * .
+ * Each function also has a batch version that transforms an array of values
+ * with one (virtual) function call. The default batch versions call the
+ * single-value versions; molstat::BinStyleKernel provides faster ones.
+ *
  * Full details about binning styles can be found in \ref sec_histograms.
  */
 class BinStyle
@@ -79,12 +83,112 @@ public:
 	 */
 	virtual double dmaskdx(const double x) const = 0;
 
+	/**
+	 * \brief The mask function for an array of values.
+	 *
+	 * \param[in] x The unmasked data values.
+	 * \param[out] u The transformed (masked) data values. May be `x`.
+	 * \param[in] n The number of values.
+	 */
+	virtual void mask(const double *x, double *u, const std::size_t n) const;
+
+	/**
+	 * \brief The inverse mask function for an array of values.
+	 *
+	 * \param[in] u The transformed (masked) data values.
+	 * \param[out] x The unmasked data values. May be `u`.
+	 * \param[in] n The number of values.
+	 */
+	virtual void invmask(const double *u, double *x, const std::size_t n)
+		const;
+
+	/**
+	 * \brief The derivative of the mask function for an array of values.
+	 *
+	 * \param[in] x The unmasked data values.
+	 * \param[out] d The derivatives evaluated at `x`. May be `x`.
+	 * \param[in] n The number of values.
+	 */
+	virtual void dmaskdx(const double *x, double *d, const std::size_t n)
+		const;
+
 	/**
 	 * \brief Create a string summary of this binning style.
 	 *
 	 * \return The string representation.
 	 */
 	virtual std::string info() const = 0;
+
+	/**
+	 * \brief Create the tokens that molstat::BinStyleFactory uses to
+	 *    construct this binning style.
+	 *
+	 * Numerical options should be written with enough digits to reproduce
+	 * the binning style exactly.
+	 *
+	 * \return The tokens (number of bins, name, and options), separated by
+	 *    spaces.
+	 */
+	virtual std::string factoryString() const = 0;
+};
+
+/**
+ * \brief Implements the functions of molstat::BinStyle with inline kernels
+ *    from the derived class.
+ *
+ * The derived class, `T`, provides nonvirtual (and preferably inline)
+ * functions `maskKernel`, `invmaskKernel`, and `dmaskdxKernel` that act on a
+ * single value. This class uses them for both the single-value and batch
+ * functions of molstat::BinStyle, so that the batch functions perform one
+ * virtual function call per array instead of one per value.
+ *
+ * \tparam T The derived binning style.
+ */
+template<typename T>
+class BinStyleKernel : public BinStyle
+{
+public:
+	using BinStyle::BinStyle;
+	virtual ~BinStyleKernel() = default;
+
+	virtual double mask(const double x) const override final
+	{
+		return static_cast<const T&>(*this).maskKernel(x);
+	}
+
+	virtual double invmask(const double u) const override final
+	{
+		return static_cast<const T&>(*this).invmaskKernel(u);
+	}
+
+	virtual double dmaskdx(const double x) const override final
+	{
+		return static_cast<const T&>(*this).dmaskdxKernel(x);
+	}
+
+	virtual void mask(const double *x, double *u, const std::size_t n) const
+		override final
+	{
+		const T &style = static_cast<const T&>(*this);
+		for(std::size_t k = 0; k < n; ++k)
+			u[k] = style.maskKernel(x[k]);
+	}
+
+	virtual void invmask(const double *u, double *x, const std::size_t n)
+		const override final
+	{
+		const T &style = static_cast<const T&>(*this);
+		for(std::size_t k = 0; k < n; ++k)
+			x[k] = style.invmaskKernel(u[k]);
+	}
+
+	virtual void dmaskdx(const double *x, double *d, const std::size_t n)
+		const override final
+	{
+		const T &style = static_cast<const T&>(*this);
+		for(std::size_t k = 0; k < n; ++k)
+			d[k] = style.dmaskdxKernel(x[k]);
+	}
 };
 
 /**
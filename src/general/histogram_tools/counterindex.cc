@@ -18,7 +18,8 @@
 namespace molstat {
 
 CounterIndex::CounterIndex(const std::vector<std::size_t> &max_index_)
-	: max_index(max_index_), index(max_index_.size() + 1, 0)
+	: max_index(max_index_), index(max_index_.size() + 1, 0),
+	  offsets(nullptr), position(0)
 	// note: add 1 dimension to index to store the "at end" bit
 {
 	// check for 0 indices
@@ -27,9 +28,43 @@ CounterIndex::CounterIndex(const std::vector<std::size_t> &max_index_)
 			throw std::invalid_argument("0 max index detected.");
 }
 
+CounterIndex::CounterIndex(const std::vector<std::size_t> &max_index_,
+	std::shared_ptr<const std::vector<std::size_t>> offsets_)
+	: CounterIndex(max_index_)
+{
+	if(offsets_ == nullptr)
+		throw std::invalid_argument("No list of bins for the CounterIndex.");
+
+	offsets = offsets_;
+	reset();
+}
+
+void CounterIndex::setOffset(std::size_t offset)
+{
+	// dimension 0 varies the fastest; see arrayOffset
+	for(std::size_t j = 0; j < max_index.size(); ++j)
+	{
+		index[j] = offset % max_index[j];
+		offset /= max_index[j];
+	}
+	index[max_index.size()] = offset;
+}
+
 CounterIndex &CounterIndex::operator++()
 {
-	if(!at_end()) // nothing to do if we're at the end
+	if(offsets != nullptr)
+	{
+		// go to the next bin in the list; past the last bin is the end
+		if(!at_end())
+		{
+			++position;
+			if(position < offsets->size())
+				setOffset((*offsets)[position]);
+			else
+				index[max_index.size()] = 1;
+		}
+	}
+	else if(!at_end()) // nothing to do if we're at the end
 	{
 		// augment the first index
 		++index[0];
@@ -85,6 +120,16 @@ void CounterIndex::reset()
 	// set all of the index counts to 0
 	for(std::size_t j = 0; j < index.size(); ++j)
 		index[j] = 0;
+
+	// or go to the first bin in the list
+	position = 0;
+	if(offsets != nullptr)
+	{
+		if(offsets->empty())
+			index[max_index.size()] = 1;
+		else
+			setOffset((*offsets)[0]);
+	}
 }
 
 bool CounterIndex::at_end() const
@@ -16,6 +16,7 @@
 #define __counter_index_h__
 
 #include <vector>
+#include <memory>
 #include <stdexcept>
 
 namespace molstat {
@@ -27,6 +28,9 @@ namespace molstat {
  * histogram. Different numbers of bins in different dimensions are allowed,
  * and the molstat::CounterIndex::arrayOffset() function calculates how this
  * bin (via its index) translates to a one-dimensional array.
+ *
+ * A counter can also be restricted to a list of bins (e.g., the occupied
+ * bins of a sparse histogram), in which case `++` visits only those bins.
  */
 class CounterIndex
 {
@@ -37,6 +41,22 @@ private:
 	/// The index represented by this counter.
 	std::vector<std::size_t> index;
 
+	/**
+	 * \brief The array offsets of the bins to visit, in increasing order, or
+	 *    null to visit all bins.
+	 */
+	std::shared_ptr<const std::vector<std::size_t>> offsets;
+
+	/// The position in `offsets` of the current bin.
+	std::size_t position;
+
+	/**
+	 * \brief Sets the index from a 1-D array offset.
+	 *
+	 * \param[in] offset The array offset.
+	 */
+	void setOffset(std::size_t offset);
+
 public:
 	CounterIndex() = delete;
 
@@ -52,6 +72,20 @@ public:
 	 */
 	CounterIndex(const std::vector<std::size_t> &max_index_);
 
+	/**
+	 * \brief Constructor for a counter that visits only some bins.
+	 *
+	 * \throw std::invalid_argument if one of the max indices is 0, or if the
+	 *    offsets are null.
+	 *
+	 * \param[in] max_index_ The maximum indices.
+	 * \param[in] offsets_ The array offsets of the bins to visit, in
+	 *    increasing order. The counter starts at the first one (or at the end
+	 *    if there are none).
+	 */
+	CounterIndex(const std::vector<std::size_t> &max_index_,
+		std::shared_ptr<const std::vector<std::size_t>> offsets_);
+
 	/**
 	 * \brief Increments the counter to the next index.
 	 *
@@ -82,7 +116,8 @@ public:
 	 */
 	std::size_t operator[] (const std::size_t dim) const;
 
-	/// Resets a counter to all 0s.
+	/// Resets a counter to all 0s (or its first bin, if restricted to a list
+	/// of bins).
 	void reset();
 
 	/// Returns true if this counter is at the end (no more `++`).
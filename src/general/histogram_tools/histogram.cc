@@ -13,16 +13,239 @@
 
 #include "histogram.h"
 #include "bin_style.h"
+#include <general/string_tools.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
 #include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 namespace molstat {
 
+/// The first characters of a binary histogram file.
+static const char histogram_magic[8] = { 'M', 'O', 'L', 'S', 'T', 'A', 'T', 'H' };
+
+/// The version of the binary histogram format.
+static constexpr std::uint32_t histogram_version = 1;
+
+/// A value for detecting the byte order of a binary histogram file.
+static constexpr std::uint32_t histogram_byte_order = 0x01020304;
+
+/// The longest binning style string accepted in a binary histogram file.
+static constexpr std::uint64_t max_style_length = 1024;
+
+/// The largest dimensionality accepted in a binary histogram file.
+static constexpr std::uint64_t max_file_dimensions = 1024;
+
+/**
+ * \brief Writes a value to a binary stream.
+ *
+ * \tparam T The type of the value.
+ * \param[in,out] out The output stream.
+ * \param[in] value The value.
+ */
+template<typename T>
+static void write_binary(std::ostream &out, const T value)
+{
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * \brief Reads a value from a binary stream.
+ *
+ * \throw std::runtime_error if the stream ends.
+ *
+ * \tparam T The type of the value.
+ * \param[in,out] in The input stream.
+ * \return The value.
+ */
+template<typename T>
+static T read_binary(std::istream &in)
+{
+	T ret;
+	if(!in.read(reinterpret_cast<char*>(&ret), sizeof(T)))
+		throw std::runtime_error("Unexpected end of the histogram file.");
+
+	return ret;
+}
+
 Histogram::Histogram(std::size_t ndim_)
-	: haveBinned(false), ndim(ndim_), data(),
+	: haveBinned(false), ndim(ndim_), streaming(false), styles(0), bounds(0),
+	  outside(0), noutside(0), data(),
 	  extremes(ndim_, {{std::numeric_limits<double>::max(),
 	                    std::numeric_limits<double>::lowest()}}),
-	  nbin_dim(ndim_, 0), bin_value(0), binned_data(0)
+	  nbin_dim(ndim_, 0), bin_value(0), binned_data(0), sparse(false),
+	  sparse_data(), occupied_offsets(nullptr), occupied_counts(0)
+{
+}
+
+Histogram::Histogram(
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	const std::vector<std::array<double, 2>> &ranges)
+	: haveBinned(false), ndim(binstyles.size()), streaming(true),
+	  styles(binstyles), bounds(0), outside(binstyles.size(), {{0, 0}}),
+	  noutside(0), data(), extremes(ranges), nbin_dim(binstyles.size(), 0),
+	  bin_value(0), binned_data(0), sparse(false), sparse_data(),
+	  occupied_offsets(nullptr), occupied_counts(0)
+{
+	if(ranges.size() != ndim)
+		throw std::invalid_argument("Incorrect number of ranges.");
+
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		if(binstyles[j] == nullptr)
+			throw std::invalid_argument(
+				"No binning style specified for dimension " + std::to_string(j) +
+					".");
+
+		if(binstyles[j]->nbins == 0)
+			throw std::invalid_argument(
+				"There must be at least 1 bin in every dimension.");
+
+		// the range must be nonempty in the masked coordinates, too
+		const double lower = binstyles[j]->mask(ranges[j][0]);
+		const double upper = binstyles[j]->mask(ranges[j][1]);
+		if(!std::isfinite(lower) || !std::isfinite(upper) || !(lower < upper))
+			throw std::invalid_argument(
+				"Invalid range for dimension " + std::to_string(j) + ".");
+	}
+
+	make_bins(styles);
+}
+
+constexpr std::size_t Histogram::chunk_size;
+
+Histogram::Chunk &Histogram::next_chunk()
 {
+	if(data.empty() || data.back().size == chunk_size)
+		data.push_back({ std::vector<double>(ndim * chunk_size), 0 });
+
+	return data.back();
+}
+
+constexpr std::size_t Histogram::block_elements;
+constexpr std::size_t Histogram::max_dense_bins;
+
+template<typename Counter>
+void Histogram::bin_elements(const double *v, std::size_t n, std::size_t ld,
+	const bool *mask,
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	Counter &&count)
+{
+	std::array<double, block_elements> masked;
+	std::array<std::size_t, block_elements> offset;
+	std::array<bool, block_elements> inside;
+
+	for(std::size_t start = 0; start < n; start += block_elements)
+	{
+		const std::size_t m = n - start < block_elements ?
+			n - start : block_elements;
+
+		for(std::size_t k = 0; k < m; ++k)
+		{
+			offset[k] = 0;
+			inside[k] = (mask == nullptr || mask[start + k]);
+		}
+
+		// the offset of a bin is sum_j (bin_j * prod_{i<j} nbin_dim[i]); see
+		// CounterIndex::arrayOffset
+		std::size_t stride = 1;
+		for(std::size_t j = 0; j < ndim; ++j)
+		{
+			const double *column = v + j * ld + start;
+			const double lower = bounds[j][0];
+			const double upper = bounds[j][1];
+			const double width = bounds[j][2];
+			const std::size_t last = nbin_dim[j] - 1;
+
+			// convert the values to the masked space
+			binstyles[j]->mask(column, masked.data(), m);
+
+			// figure out which bin for this dimension
+			if(streaming)
+			{
+				for(std::size_t k = 0; k < m; ++k)
+				{
+					if(mask != nullptr && !mask[start + k])
+						continue;
+
+					// is the value outside the range? (NaN is underflow)
+					if(!(masked[k] >= lower))
+					{
+						++outside[j][0];
+						inside[k] = false;
+					}
+					else if(masked[k] > upper)
+					{
+						++outside[j][1];
+						inside[k] = false;
+					}
+					else
+					{
+						// the upper bound (and any roundoff) goes in the last bin
+						const std::size_t bin = static_cast<std::size_t>(
+							(masked[k] - lower) / width);
+						offset[k] += stride * (bin < last ? bin : last);
+					}
+				}
+			}
+			else if(last == 0) // only 1 bin to put it in
+			{
+			}
+			else
+			{
+				for(std::size_t k = 0; k < m; ++k)
+				{
+					if(!inside[k])
+						continue;
+
+					if(masked[k] == upper) // the upper bound
+						offset[k] += stride * last;
+					else
+					{
+						const std::size_t bin = static_cast<std::size_t>(
+							(masked[k] - lower) / width);
+						offset[k] += stride * (bin < last ? bin : last);
+					}
+				}
+			}
+
+			stride *= nbin_dim[j];
+		}
+
+		// increase the bin counts
+		for(std::size_t k = 0; k < m; ++k)
+		{
+			if(inside[k])
+				count(start + k, offset[k]);
+			else if(mask == nullptr || mask[start + k])
+				++noutside;
+		}
+	}
+}
+
+void Histogram::stream_data(const double *v, std::size_t n, std::size_t ld,
+	const bool *mask)
+{
+	if(sparse)
+	{
+		bin_elements(v, n, ld, mask, styles,
+			[this] (std::size_t, std::size_t offset) -> void
+			{
+				sparse_data[offset] += 1.;
+			});
+	}
+	else
+	{
+		bin_elements(v, n, ld, mask, styles,
+			[this] (std::size_t, std::size_t offset) -> void
+			{
+				binned_data[offset] += 1.;
+			});
+	}
 }
 
 void Histogram::add_data(std::valarray<double> v)
@@ -33,31 +256,232 @@ void Histogram::add_data(std::valarray<double> v)
 	if(v.size() != ndim)
 		throw std::invalid_argument("Data has incorrect dimensionality.");
 
-	// check the limits
+	add_data(&v[0], 1, 1);
+}
+
+void Histogram::add_data(const double *v, std::size_t n, std::size_t ld,
+	const bool *mask)
+{
+	if(haveBinned)
+		throw std::runtime_error("Cannot add data after binning the histogram.");
+
+	if(streaming)
+	{
+		stream_data(v, n, ld, mask);
+		return;
+	}
+
+	for(std::size_t k = 0; k < n; ++k)
+	{
+		if(mask != nullptr && !mask[k])
+			continue;
+
+		Chunk &chunk = next_chunk();
+		for(std::size_t j = 0; j < ndim; ++j)
+		{
+			const double element{ v[j * ld + k] };
+
+			// check the limits
+			if(element < extremes[j][0]) // are we smaller than the min?
+				extremes[j][0] = element;
+			if(element > extremes[j][1]) // are we larger than the max?
+				extremes[j][1] = element;
+
+			chunk.values[j * chunk_size + chunk.size] = element;
+		}
+		++chunk.size;
+	}
+}
+
+void Histogram::merge(Histogram &other)
+{
+	if(haveBinned || other.haveBinned)
+		throw std::runtime_error("Cannot merge histograms after binning.");
+
+	if(other.ndim != ndim)
+		throw std::invalid_argument("Data has incorrect dimensionality.");
+
+	if(other.streaming != streaming)
+		throw std::invalid_argument(
+			"Cannot merge streaming and non-streaming histograms.");
+
+	if(streaming)
+	{
+		// the bins must be the same
+		if(other.nbin_dim != nbin_dim || other.bounds != bounds)
+			throw std::invalid_argument(
+				"Cannot merge streaming histograms with different bins.");
+
+		for(std::size_t k = 0; k < binned_data.size(); ++k)
+		{
+			binned_data[k] += other.binned_data[k];
+			other.binned_data[k] = 0.;
+		}
+
+		for(const auto &bin : other.sparse_data)
+			sparse_data[bin.first] += bin.second;
+		other.sparse_data.clear();
+
+		for(std::size_t j = 0; j < ndim; ++j)
+		{
+			outside[j][0] += other.outside[j][0];
+			outside[j][1] += other.outside[j][1];
+			other.outside[j][0] = other.outside[j][1] = 0;
+		}
+
+		noutside += other.noutside;
+		other.noutside = 0;
+
+		return;
+	}
+
+	// combine the limits
 	for(std::size_t j = 0; j < ndim; ++j)
 	{
-		if(v[j] < extremes[j][0]) // are we smaller than the min?
-			extremes[j][0] = v[j];
-		if(v[j] > extremes[j][1]) // are we larger than the max?
-			extremes[j][1] = v[j];
+		if(other.extremes[j][0] < extremes[j][0])
+			extremes[j][0] = other.extremes[j][0];
+		if(other.extremes[j][1] > extremes[j][1])
+			extremes[j][1] = other.extremes[j][1];
+
+		// reset the other histogram's limits
+		other.extremes[j][0] = std::numeric_limits<double>::max();
+		other.extremes[j][1] = std::numeric_limits<double>::lowest();
 	}
 
-	// move the data
-	data.emplace_front(move(v));
+	// move the data; the order of the data is irrelevant. the chunks
+	// themselves are moved, not copied
+	data.reserve(data.size() + other.data.size());
+	for(Chunk &chunk : other.data)
+		data.emplace_back(std::move(chunk));
+	other.data.clear();
 }
 
-void Histogram::bin_data(
+void Histogram::make_bins(
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles)
+{
+	// the offset of every bin must fit in a std::size_t
+	std::size_t total_bins = 1;
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		if(total_bins > std::numeric_limits<std::size_t>::max() /
+			binstyles[j]->nbins)
+		{
+			throw std::invalid_argument("Too many bins.");
+		}
+		total_bins *= binstyles[j]->nbins;
+	}
+
+	// determine the bounds of each dimension (in masked coordinates), as well
+	// as the width of each bin (in masked coordinates)
+	bounds.resize(ndim);
+	bin_value.resize(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		bounds[j][0] = binstyles[j]->mask(extremes[j][0]); // minimum
+		bounds[j][1] = binstyles[j]->mask(extremes[j][1]); // maximum
+		bounds[j][2] = (bounds[j][1] - bounds[j][0]) / binstyles[j]->nbins;
+	
+		// set the values of the bins for this dimension
+		bin_value[j] = bin_values(bounds[j][0], bounds[j][1], bounds[j][2],
+			binstyles[j]);
+	}
+
+	// set the size of binned_data vector; only the occupied bins of a sparse
+	// histogram are stored
+	sparse = (total_bins > max_dense_bins);
+	sparse_data.clear();
+	binned_data.assign(sparse ? 0 : total_bins, 0.);
+
+	// set up the indexor for accesing the bins in binned_data
+	// -> need to get the number of bins in each dimension
+	for(std::size_t j = 0; j < ndim; ++j)
+		nbin_dim[j] = binstyles[j]->nbins;
+}
+
+void Histogram::apply_weights(
 	const std::vector<std::shared_ptr<const BinStyle>> &binstyles)
+{
+	// apply the weight function to account for the bin sizes
+	std::vector<std::vector<double>> weights(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		weights[j].resize(nbin_dim[j]);
+		binstyles[j]->dmaskdx(bin_value[j].data(), weights[j].data(),
+			nbin_dim[j]);
+	}
+
+	if(sparse)
+	{
+		// sort the occupied bins
+		std::shared_ptr<std::vector<std::size_t>> offsets{
+			std::make_shared<std::vector<std::size_t>>() };
+		offsets->reserve(sparse_data.size());
+		for(const auto &bin : sparse_data)
+			offsets->push_back(bin.first);
+		std::sort(offsets->begin(), offsets->end());
+
+		occupied_counts.resize(offsets->size());
+		for(std::size_t k = 0; k < offsets->size(); ++k)
+		{
+			// the weights are applied in the same order as for a dense histogram
+			std::size_t offset = (*offsets)[k];
+			double count = sparse_data[offset];
+			for(std::size_t j = 0; j < ndim; ++j)
+			{
+				count *= weights[j][offset % nbin_dim[j]];
+				offset /= nbin_dim[j];
+			}
+			occupied_counts[k] = count;
+		}
+
+		occupied_offsets = offsets;
+		sparse_data.clear();
+
+		// note that we've finished the binning
+		haveBinned = true;
+		return;
+	}
+
+	// bin (i_0, i_1, ...) is at offset i_0 + nbin_dim[0] * (i_1 + ...), so,
+	// for dimension j, the bins form blocks of stride consecutive bins (stride
+	// is the product of nbin_dim[i] for i < j) that share the same index i_j
+	std::size_t stride = 1;
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		for(std::size_t start = 0; start < binned_data.size();
+			start += stride * nbin_dim[j])
+		{
+			for(std::size_t i = 0; i < nbin_dim[j]; ++i)
+			{
+				double *bins = binned_data.data() + start + i * stride;
+				for(std::size_t k = 0; k < stride; ++k)
+					bins[k] *= weights[j][i];
+			}
+		}
+
+		stride *= nbin_dim[j];
+	}
+
+	// note that we've finished the binning
+	haveBinned = true;
+}
+
+void Histogram::bin_data(
+	const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+	std::size_t nthreads)
 {
 	if(haveBinned)
 		throw std::runtime_error("Data has already been binned.");
 
+	if(streaming)
+		throw std::runtime_error(
+			"A streaming histogram uses its own binning styles.");
+
 	if(binstyles.size() != ndim)
 		throw std::invalid_argument("Incorrect number of binning styles.");
 
 	// make sure that, if more than 1 bin is specified in a dimension, there is
 	// a range of data values
-	std::size_t total_bins = 1;
 	for(std::size_t j = 0; j < ndim; ++j)
 	{
 		if(binstyles[j] == nullptr)
@@ -71,74 +495,452 @@ void Histogram::bin_data(
 
 		if(extremes[j][0] == extremes[j][1] && binstyles[j]->nbins != 1)
 			throw j;
+	}
 
-		total_bins *= binstyles[j]->nbins;
+	make_bins(binstyles);
+	styles = binstyles;
+
+	// go through the data, one chunk at a time; the chunks are dealt out to
+	// the threads. the first thread counts directly in the histogram and each
+	// other thread in its own set of bins (or its own map of occupied bins, for
+	// a sparse histogram)
+	const std::size_t total_bins{ binned_data.size() };
+	if(nthreads > data.size())
+		nthreads = data.size();
+	if(nthreads == 0)
+		nthreads = 1;
+
+	// the other threads' dense counts together hold at most max_dense_bins
+	// bins (the size of the largest dense histogram); otherwise use fewer
+	// threads
+	if(!sparse && nthreads > 1 && (nthreads - 1) * total_bins > max_dense_bins)
+		nthreads = 1 + max_dense_bins / total_bins;
+
+	std::vector<std::vector<double>> counts(nthreads);
+	std::vector<std::unordered_map<std::size_t, double>> sparse_counts(
+		sparse ? nthreads : 0);
+	std::vector<std::exception_ptr> errors(nthreads, nullptr);
+
+	auto worker = [&] (std::size_t thread) -> void
+	{
+		try
+		{
+			if(sparse)
+			{
+				std::unordered_map<std::size_t, double> &mycounts =
+					sparse_counts[thread];
+
+				for(std::size_t c = thread; c < data.size(); c += nthreads)
+				{
+					bin_elements(data[c].values.data(), data[c].size, chunk_size,
+						nullptr, binstyles,
+						[&mycounts] (std::size_t, std::size_t offset) -> void
+						{
+							mycounts[offset] += 1.;
+						});
+				}
+
+				return;
+			}
+
+			double *mycounts = binned_data.data();
+			if(thread > 0)
+			{
+				counts[thread].assign(total_bins, 0.);
+				mycounts = counts[thread].data();
+			}
+
+			for(std::size_t c = thread; c < data.size(); c += nthreads)
+			{
+				bin_elements(data[c].values.data(), data[c].size, chunk_size,
+					nullptr, binstyles,
+					[mycounts] (std::size_t, std::size_t offset) -> void
+					{
+						mycounts[offset] += 1.;
+					});
+			}
+		}
+		catch(...)
+		{
+			errors[thread] = std::current_exception();
+		}
+	};
+
+	if(nthreads == 1)
+		worker(0);
+	else
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(nthreads);
+		for(std::size_t t = 0; t < nthreads; ++t)
+			workers.emplace_back(worker, t);
+
+		for(auto &t : workers)
+			t.join();
 	}
 
-	// determine the bounds of each dimension (in masked coordinates), as well
-	// as the width of each bin (in masked coordinates)
-	std::vector<std::array<double, 3>> bounds(ndim);
-	bin_value.resize(ndim);
-	for(std::size_t j = 0; j < ndim; ++j)
+	// combine the counts; they are integers, so the order of the sums does
+	// not matter
+	for(std::size_t t = 0; t < nthreads; ++t)
 	{
-		bounds[j][0] = binstyles[j]->mask(extremes[j][0]); // minimum
-		bounds[j][1] = binstyles[j]->mask(extremes[j][1]); // maximum
-		bounds[j][2] = (bounds[j][1] - bounds[j][0]) / binstyles[j]->nbins;
-	
-		// set the values of the bins for this dimension
-		bin_value[j] = bin_values(bounds[j][0], bounds[j][1], bounds[j][2],
-			binstyles[j]);
+		if(errors[t] != nullptr)
+			std::rethrow_exception(errors[t]);
+
+		if(sparse)
+		{
+			for(const auto &bin : sparse_counts[t])
+				sparse_data[bin.first] += bin.second;
+			sparse_counts[t].clear();
+			continue;
+		}
+
+		if(t > 0)
+		{
+			for(std::size_t k = 0; k < total_bins; ++k)
+				binned_data[k] += counts[t][k];
+		}
 	}
 
-	// set the size of binned_data vector
-	binned_data.resize(total_bins);
-	for(std::size_t j = 0; j < total_bins; ++j)
-		binned_data[j] = 0.;
+	// discard the data
+	data.clear();
+	data.shrink_to_fit();
+
+	apply_weights(binstyles);
+}
+
+void Histogram::bin_data()
+{
+	if(haveBinned)
+		throw std::runtime_error("Data has already been binned.");
+
+	if(!streaming)
+		throw std::runtime_error(
+			"Binning styles are needed to bin a non-streaming histogram.");
+
+	apply_weights(styles);
+}
+
+void Histogram::accumulate(const Histogram &other)
+{
+	if(!haveBinned || !other.haveBinned)
+		throw std::runtime_error(
+			"Histograms must be binned before they are accumulated.");
+
+	if(other.ndim != ndim || other.nbin_dim != nbin_dim ||
+		other.bounds != bounds)
+	{
+		throw std::invalid_argument(
+			"Cannot accumulate histograms with different bins.");
+	}
+
+	if(other.streaming != streaming)
+		throw std::invalid_argument(
+			"Cannot accumulate streaming and non-streaming histograms.");
 
-	// set up the indexor for accesing the bins in binned_data
-	// -> need to get the number of bins in each dimension
 	for(std::size_t j = 0; j < ndim; ++j)
-		nbin_dim[j] = binstyles[j]->nbins;
-	CounterIndex ci{ nbin_dim };
+	{
+		if(styles[j]->factoryString() != other.styles[j]->factoryString())
+			throw std::invalid_argument(
+				"Cannot accumulate histograms with different binning styles.");
+	}
 
-	// go through the data
-	while(!data.empty())
+	// the histograms have the same number of bins, so both are sparse or
+	// neither is
+	if(sparse)
+	{
+		// merge the (sorted) lists of occupied bins
+		const std::vector<std::size_t> &offsets1 = *occupied_offsets;
+		const std::vector<std::size_t> &offsets2 = *other.occupied_offsets;
+		std::shared_ptr<std::vector<std::size_t>> offsets{
+			std::make_shared<std::vector<std::size_t>>() };
+		std::vector<double> counts;
+		offsets->reserve(offsets1.size() + offsets2.size());
+		counts.reserve(offsets1.size() + offsets2.size());
+
+		std::size_t k1{ 0 }, k2{ 0 };
+		while(k1 < offsets1.size() || k2 < offsets2.size())
+		{
+			if(k2 == offsets2.size() ||
+				(k1 < offsets1.size() && offsets1[k1] < offsets2[k2]))
+			{
+				offsets->push_back(offsets1[k1]);
+				counts.push_back(occupied_counts[k1]);
+				++k1;
+			}
+			else if(k1 == offsets1.size() || offsets2[k2] < offsets1[k1])
+			{
+				offsets->push_back(offsets2[k2]);
+				counts.push_back(other.occupied_counts[k2]);
+				++k2;
+			}
+			else
+			{
+				offsets->push_back(offsets1[k1]);
+				counts.push_back(occupied_counts[k1] + other.occupied_counts[k2]);
+				++k1;
+				++k2;
+			}
+		}
+
+		occupied_offsets = offsets;
+		occupied_counts = std::move(counts);
+	}
+	else
+	{
+		for(std::size_t k = 0; k < binned_data.size(); ++k)
+			binned_data[k] += other.binned_data[k];
+	}
+
+	if(streaming)
 	{
 		for(std::size_t j = 0; j < ndim; ++j)
 		{
-			// convert each value to the masked space
-			double element = binstyles[j]->mask(data.front()[j]);
+			outside[j][0] += other.outside[j][0];
+			outside[j][1] += other.outside[j][1];
+		}
+	}
+	noutside += other.noutside;
+}
 
-			// figure out which bin for this dimension
-			if(binstyles[j]->nbins == 1) // only 1 bin to put it in
-				ci.setIndex(j, 0);
-			else if(element == bounds[j][1]) // the upper bound
-				ci.setIndex(j, nbin_dim[j] - 1);
-			else
-				ci.setIndex(j, static_cast<std::size_t>(
-					(element - bounds[j][0]) / bounds[j][2]
-				));
+void Histogram::serialize(std::ostream &out) const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot write a histogram before binning.");
+
+	// header
+	out.write(histogram_magic, sizeof(histogram_magic));
+	write_binary<std::uint32_t>(out, histogram_version);
+	write_binary<std::uint32_t>(out, histogram_byte_order);
+	write_binary<std::uint64_t>(out, ndim);
+	write_binary<std::uint8_t>(out, (streaming ? 1 : 0) | (sparse ? 2 : 0));
+
+	// each dimension
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		const std::string style{ styles[j]->factoryString() };
+		write_binary<std::uint64_t>(out, style.size());
+		out.write(style.data(), style.size());
+
+		write_binary<std::uint64_t>(out, nbin_dim[j]);
+		for(std::size_t k = 0; k < 3; ++k)
+			write_binary<double>(out, bounds[j][k]);
+		for(std::size_t k = 0; k < 2; ++k)
+			write_binary<double>(out, extremes[j][k]);
+		write_binary<std::uint64_t>(out, getUnderflow(j));
+		write_binary<std::uint64_t>(out, getOverflow(j));
+	}
+	write_binary<std::uint64_t>(out, noutside);
+
+	// the bins
+	if(sparse)
+	{
+		write_binary<std::uint64_t>(out, occupied_offsets->size());
+		for(std::size_t offset : *occupied_offsets)
+			write_binary<std::uint64_t>(out, offset);
+		out.write(reinterpret_cast<const char*>(occupied_counts.data()),
+			occupied_counts.size() * sizeof(double));
+	}
+	else
+	{
+		write_binary<std::uint64_t>(out, binned_data.size());
+		out.write(reinterpret_cast<const char*>(binned_data.data()),
+			binned_data.size() * sizeof(double));
+	}
+
+	if(!out)
+		throw std::runtime_error("Unable to write the histogram.");
+}
+
+std::unique_ptr<Histogram> Histogram::deserialize(std::istream &in)
+{
+	// header
+	char magic[sizeof(histogram_magic)];
+	if(!in.read(magic, sizeof(magic)) ||
+		!std::equal(magic, magic + sizeof(magic), histogram_magic))
+	{
+		throw std::runtime_error("Not a MolStat histogram file.");
+	}
+
+	const std::uint32_t version{ read_binary<std::uint32_t>(in) };
+	if(version != histogram_version)
+		throw std::runtime_error("Unsupported histogram file version " +
+			std::to_string(version) + ".");
+
+	if(read_binary<std::uint32_t>(in) != histogram_byte_order)
+		throw std::runtime_error(
+			"The histogram file was written with a different byte order.");
+
+	const std::uint64_t ndim_{ read_binary<std::uint64_t>(in) };
+	if(ndim_ == 0 || ndim_ > max_file_dimensions)
+		throw std::runtime_error("Invalid dimensionality in the histogram file.");
+
+	const std::uint8_t flags{ read_binary<std::uint8_t>(in) };
+
+	std::unique_ptr<Histogram> ret{ new Histogram(ndim_) };
+	Histogram &hist = *ret;
+	hist.streaming = (flags & 1) != 0;
+	hist.styles.resize(hist.ndim);
+	hist.bounds.resize(hist.ndim);
+	hist.bin_value.resize(hist.ndim);
+	if(hist.streaming)
+		hist.outside.resize(hist.ndim);
+
+	// each dimension
+	std::size_t total_bins{ 1 };
+	for(std::size_t j = 0; j < hist.ndim; ++j)
+	{
+		const std::uint64_t length{ read_binary<std::uint64_t>(in) };
+		if(length > max_style_length)
+			throw std::runtime_error("Invalid binning style in the histogram file.");
+
+		std::string style(length, ' ');
+		if(!in.read(&style[0], length))
+			throw std::runtime_error("Unexpected end of the histogram file.");
+
+		try
+		{
+			hist.styles[j] = BinStyleFactory(tokenize(style));
+		}
+		catch(const std::invalid_argument &e)
+		{
+			throw std::runtime_error(
+				"Invalid binning style in the histogram file.");
 		}
 
-		// increase the bin count
-		binned_data[ci.arrayOffset()] += 1.;
+		const std::uint64_t nbins{ read_binary<std::uint64_t>(in) };
+		if(nbins == 0 || nbins != hist.styles[j]->nbins ||
+			total_bins > std::numeric_limits<std::size_t>::max() / nbins)
+		{
+			throw std::runtime_error(
+				"Invalid number of bins in the histogram file.");
+		}
+		hist.nbin_dim[j] = nbins;
+		total_bins *= nbins;
 
-		// discard this data point
-		data.pop_front();
+		for(std::size_t k = 0; k < 3; ++k)
+			hist.bounds[j][k] = read_binary<double>(in);
+		for(std::size_t k = 0; k < 2; ++k)
+			hist.extremes[j][k] = read_binary<double>(in);
+
+		const std::uint64_t underflow{ read_binary<std::uint64_t>(in) };
+		const std::uint64_t overflow{ read_binary<std::uint64_t>(in) };
+		if(hist.streaming)
+			hist.outside[j] = {{ underflow, overflow }};
+
+		hist.bin_value[j] = bin_values(hist.bounds[j][0], hist.bounds[j][1],
+			hist.bounds[j][2], hist.styles[j]);
 	}
+	hist.noutside = read_binary<std::uint64_t>(in);
 
-	// apply the weight function to account for the bin sizes
-	for(ci.reset(); !ci.at_end(); ++ci)
+	// the bins, which may have been stored differently
+	const std::uint64_t nstored{ read_binary<std::uint64_t>(in) };
+	const bool stored_sparse{ (flags & 2) != 0 };
+	std::vector<std::size_t> offsets;
+	if(stored_sparse)
 	{
-		for(std::size_t j = 0; j < ndim; ++j)
+		if(nstored > total_bins)
+			throw std::runtime_error("Invalid number of bins in the histogram file.");
+
+		offsets.resize(nstored);
+		for(std::size_t k = 0; k < nstored; ++k)
 		{
-			binned_data[ci.arrayOffset()] *= binstyles[j]->dmaskdx(
-				bin_value[j][ci[j]]);
+			offsets[k] = read_binary<std::uint64_t>(in);
+			if(offsets[k] >= total_bins || (k > 0 && offsets[k] <= offsets[k-1]))
+				throw std::runtime_error("Invalid bin in the histogram file.");
 		}
 	}
+	else if(nstored != total_bins)
+		throw std::runtime_error("Invalid number of bins in the histogram file.");
 
-	// note that we've finished the binning
-	haveBinned = true;
+	std::vector<double> counts(nstored);
+	if(!in.read(reinterpret_cast<char*>(counts.data()),
+		nstored * sizeof(double)))
+	{
+		throw std::runtime_error("Unexpected end of the histogram file.");
+	}
+
+	hist.sparse = (total_bins > max_dense_bins);
+	if(hist.sparse)
+	{
+		// keep the occupied bins
+		std::shared_ptr<std::vector<std::size_t>> occupied{
+			std::make_shared<std::vector<std::size_t>>() };
+		for(std::size_t k = 0; k < nstored; ++k)
+		{
+			if(counts[k] != 0.)
+			{
+				occupied->push_back(stored_sparse ? offsets[k] : k);
+				hist.occupied_counts.push_back(counts[k]);
+			}
+		}
+		hist.occupied_offsets = occupied;
+	}
+	else if(stored_sparse)
+	{
+		hist.binned_data.assign(total_bins, 0.);
+		for(std::size_t k = 0; k < nstored; ++k)
+			hist.binned_data[offsets[k]] = counts[k];
+	}
+	else
+		hist.binned_data = std::move(counts);
+
+	hist.haveBinned = true;
+	return ret;
+}
+
+std::size_t Histogram::getDimensionality() const noexcept
+{
+	return ndim;
+}
+
+const std::vector<double> &Histogram::getBinValues(std::size_t dim) const
+{
+	if(!haveBinned)
+		throw std::runtime_error("Cannot get coordinates before binning.");
+
+	if(dim >= ndim)
+		throw std::out_of_range("Invalid dimension.");
+
+	return bin_value[dim];
+}
+
+bool Histogram::isStreaming() const noexcept
+{
+	return streaming;
+}
+
+bool Histogram::isSparse() const noexcept
+{
+	return sparse;
+}
+
+std::size_t Histogram::numOutside() const noexcept
+{
+	return noutside;
+}
+
+std::array<double, 2> Histogram::getExtremes(std::size_t dim) const
+{
+	if(dim >= ndim)
+		throw std::out_of_range("Invalid dimension.");
+
+	return extremes[dim];
+}
+
+std::size_t Histogram::getUnderflow(std::size_t dim) const
+{
+	if(dim >= ndim)
+		throw std::out_of_range("Invalid dimension.");
+
+	return streaming ? outside[dim][0] : 0;
+}
+
+std::size_t Histogram::getOverflow(std::size_t dim) const
+{
+	if(dim >= ndim)
+		throw std::out_of_range("Invalid dimension.");
+
+	return streaming ? outside[dim][1] : 0;
 }
 
 std::vector<double> Histogram::bin_values(double dmin, double dmax,
@@ -149,12 +951,13 @@ std::vector<double> Histogram::bin_values(double dmin, double dmax,
 	// lower bound of bin j is (dmin + j * dwidth)
 	// upper bound of bin j is (dmin + (j+1) * dwidth)
 	// we unmask these values and get the average
+	std::vector<double> edges(bstyle->nbins + 1);
+	for(std::size_t j = 0; j <= bstyle->nbins; ++j)
+		edges[j] = dmin + j * dwidth;
+	bstyle->invmask(edges.data(), edges.data(), edges.size());
+
 	for(std::size_t j = 0; j < bstyle->nbins; ++j)
-	{
-		const double lower = bstyle->invmask(dmin + j * dwidth);
-		const double upper = bstyle->invmask(dmin + (j+1) * dwidth);
-		ret[j] = 0.5 * (lower + upper);
-	}
+		ret[j] = 0.5 * (edges[j] + edges[j+1]);
 
 	return ret;
 }
@@ -164,6 +967,9 @@ CounterIndex Histogram::begin() const
 	if(!haveBinned)
 		throw std::runtime_error("Cannot access an iterator before binning.");
 
+	if(sparse)
+		return CounterIndex(nbin_dim, occupied_offsets);
+
 	return CounterIndex(nbin_dim);
 }
 
@@ -187,6 +993,19 @@ double Histogram::getBinCount(const CounterIndex &index) const
 	if(!haveBinned)
 		throw std::runtime_error("Cannot get a bin count before binning.");
 
+	if(sparse)
+	{
+		// look for the bin among the occupied bins
+		const std::size_t offset{ index.arrayOffset() };
+		const auto iter = std::lower_bound(occupied_offsets->cbegin(),
+			occupied_offsets->cend(), offset);
+
+		if(iter == occupied_offsets->cend() || *iter != offset)
+			return 0.;
+
+		return occupied_counts[iter - occupied_offsets->cbegin()];
+	}
+
 	return binned_data[index.arrayOffset()];
 }
 
@@ -15,10 +15,11 @@
 #define __histogram_h__
 
 #include <memory>
+#include <iostream>
 #include <valarray>
 #include <vector>
-#include <forward_list>
 #include <array>
+#include <unordered_map>
 #include "counterindex.h"
 
 namespace molstat {
@@ -39,7 +40,21 @@ class BinStyle;
  * bounds of the data. As data is added, the class tracks the minimum and
  * maximum values.
  *
- * Histograms of any dimensionality can be constructed.
+ * Alternatively, if the range of each dimension is known ahead of time, the
+ * histogram can be \"streaming\": each data element is binned as it is
+ * added and not stored, so that the memory is independent of the amount of
+ * data. Data outside the range is counted (underflow or overflow, for each
+ * dimension) but not binned.
+ *
+ * Histograms of any dimensionality can be constructed. If the total number of
+ * bins is large (more than molstat::Histogram::max_dense_bins), only the
+ * occupied bins are stored (the histogram is \"sparse\"), and iterating
+ * over the histogram visits only the occupied bins.
+ *
+ * A binned histogram can be written to (and read from) a binary file; see
+ * molstat::Histogram::serialize(). Histograms with the same bins (e.g.,
+ * streaming histograms from independent simulations) can then be summed
+ * with molstat::Histogram::accumulate().
  */
 class Histogram
 {
@@ -51,8 +66,55 @@ private:
 	/// The dimensionality of the data.
 	const std::size_t ndim;
 
-	/// The accumulated data.
-	std::forward_list<std::valarray<double>> data;
+	/// True if data is binned as it is added (the range is fixed).
+	bool streaming;
+
+	/// The binning styles (set at construction for a streaming histogram and
+	/// when binning otherwise).
+	std::vector<std::shared_ptr<const BinStyle>> styles;
+
+	/**
+	 * \brief The bounds of each dimension in masked coordinates.
+	 *
+	 * The elements are the minimum, the maximum, and the width of each bin.
+	 */
+	std::vector<std::array<double, 3>> bounds;
+
+	/**
+	 * \brief The number of data elements below (underflow) and above
+	 *    (overflow) the range of each dimension, for a streaming histogram.
+	 */
+	std::vector<std::array<std::size_t, 2>> outside;
+
+	/// The number of data elements outside the range in any dimension.
+	std::size_t noutside;
+
+	/**
+	 * \brief A block of accumulated data.
+	 *
+	 * The data is stored by dimension (structure of arrays): element `k` of
+	 * dimension `j` is `values[j * chunk_size + k]`.
+	 */
+	struct Chunk
+	{
+		/// The values, with room for chunk_size elements.
+		std::vector<double> values;
+
+		/// The number of elements stored in the chunk.
+		std::size_t size;
+	};
+
+	/// The number of data elements in each chunk.
+	static constexpr std::size_t chunk_size = 16384;
+
+	/**
+	 * \brief The accumulated data.
+	 *
+	 * Chunks are allocated as needed and never reallocated, so adding data
+	 * does not copy the data already stored. Only the last chunk receives new
+	 * data (chunks from merged histograms may also be partially filled).
+	 */
+	std::vector<Chunk> data;
 
 	/// The minimum and maximum values in each dimension.
 	std::vector<std::array<double, 2>> extremes;
@@ -67,9 +129,28 @@ private:
 	 */
 	std::vector<std::vector<double>> bin_value;
 
-	/// The counts in each bin.
+	/// The counts in each bin (if the histogram is not sparse).
 	std::vector<double> binned_data;
 
+	/// True if only the occupied bins are stored.
+	bool sparse;
+
+	/**
+	 * \brief The counts in the occupied bins of a sparse histogram, keyed by
+	 *    array offset (see molstat::CounterIndex::arrayOffset()).
+	 *
+	 * Used until the weights are applied; the counts are then moved to
+	 * occupied_offsets and occupied_counts.
+	 */
+	std::unordered_map<std::size_t, double> sparse_data;
+
+	/// The array offsets of the occupied bins of a sparse histogram, in
+	/// increasing order.
+	std::shared_ptr<const std::vector<std::size_t>> occupied_offsets;
+
+	/// The counts in the occupied bins of a sparse histogram.
+	std::vector<double> occupied_counts;
+
 	/**
 	 * \brief Calculates the values of the bins (for a particular dimension).
 	 *
@@ -82,7 +163,93 @@ private:
 	static std::vector<double> bin_values(double dmin, double dmax,
 		double dwidth, std::shared_ptr<const BinStyle> bstyle);
 
+	/**
+	 * \brief Gets the chunk where the next data element is stored,
+	 *    allocating it if necessary.
+	 *
+	 * \return The chunk.
+	 */
+	Chunk &next_chunk();
+
+	/// The number of data elements processed at once by bin_elements().
+	static constexpr std::size_t block_elements = 256;
+
+	/**
+	 * \brief Bins data elements, stored by dimension.
+	 *
+	 * The elements are processed in blocks: each dimension of the block is
+	 * masked and converted to bin indices, the bin offsets are accumulated,
+	 * and then the counts are incremented.
+	 *
+	 * For a streaming histogram, elements outside the range are counted as
+	 * underflow/overflow and not binned. Otherwise, the elements must be
+	 * within the extremes, and the histogram is not modified (except by
+	 * `count`); several threads may then call this function at once.
+	 *
+	 * \tparam Counter The type of `count`.
+	 * \param[in] v The data; dimension `j` of element `k` is `v[j * ld + k]`.
+	 * \param[in] n The number of data elements.
+	 * \param[in] ld The leading dimension of `v`.
+	 * \param[in] mask If not null, only elements `k` with `mask[k]` true are
+	 *    binned.
+	 * \param[in] binstyles The binning styles.
+	 * \param[in] count Increments the count of a bin; called as
+	 *    `count(k, offset)` for element `k` in the bin with array offset
+	 *    `offset`.
+	 */
+	template<typename Counter>
+	void bin_elements(const double *v, std::size_t n, std::size_t ld,
+		const bool *mask,
+		const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+		Counter &&count);
+
+	/**
+	 * \brief Bins data elements into a streaming histogram.
+	 *
+	 * \param[in] v The data; dimension `j` of element `k` is `v[j * ld + k]`.
+	 * \param[in] n The number of data elements.
+	 * \param[in] ld The leading dimension of `v`.
+	 * \param[in] mask If not null, only elements `k` with `mask[k]` true are
+	 *    binned.
+	 */
+	void stream_data(const double *v, std::size_t n, std::size_t ld,
+		const bool *mask);
+
+	/**
+	 * \brief Sets up the (empty) bins, using the extremes of each dimension.
+	 *
+	 * The histogram is made sparse if there are more than max_dense_bins bins.
+	 *
+	 * \throw std::invalid_argument if the total number of bins is too large to
+	 *    be indexed.
+	 *
+	 * \param[in] binstyles The binning styles.
+	 */
+	void make_bins(
+		const std::vector<std::shared_ptr<const BinStyle>> &binstyles);
+
+	/**
+	 * \brief Applies the weight function to the bin counts to account for the
+	 *    bin sizes, completing the binning.
+	 *
+	 * The weight of a bin is the product of the binning styles' derivatives
+	 * (evaluated at the bin's coordinate in each dimension). The derivatives
+	 * for each dimension are calculated once and applied to all bins.
+	 *
+	 * For a sparse histogram, the occupied bins are also sorted by offset.
+	 *
+	 * \param[in] binstyles The binning styles.
+	 */
+	void apply_weights(
+		const std::vector<std::shared_ptr<const BinStyle>> &binstyles);
+
 public:
+	/**
+	 * \brief The largest total number of bins that are all stored; histograms
+	 *    with more bins are sparse.
+	 */
+	static constexpr std::size_t max_dense_bins = std::size_t(1) << 22;
+
 	Histogram() = delete;
 	
 	/**
@@ -92,9 +259,28 @@ public:
 	 */
 	Histogram(std::size_t ndim_);
 
+	/**
+	 * \brief Constructor for a streaming histogram, where the range of each
+	 *    dimension is specified.
+	 *
+	 * \throw std::invalid_argument if the number of ranges doesn't match the
+	 *    number of binning styles, if a binning style is null or has 0 bins,
+	 *    if a range is empty or invalid for its binning style (e.g., a
+	 *    non-positive value with logarithmic binning), or if there are too
+	 *    many bins.
+	 *
+	 * \param[in] binstyles The binning styles.
+	 * \param[in] ranges The minimum and maximum value of each dimension.
+	 */
+	Histogram(const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+		const std::vector<std::array<double, 2>> &ranges);
+
 	/**
 	 * \brief Adds a data element to the histogram.
 	 *
+	 * For a streaming histogram, the element is binned immediately (or
+	 * counted as underflow/overflow).
+	 *
 	 * \throw std::invalid_argument if the data has the wrong dimensionality.
 	 * \throw std::runtime_error if the bins have already been formed.
 	 *
@@ -102,26 +288,219 @@ public:
 	 */
 	void add_data(std::valarray<double> v);
 
+	/**
+	 * \brief Adds a batch of data elements to the histogram.
+	 *
+	 * The batch is stored by dimension: dimension `j` of element `k` is
+	 * `v[j * ld + k]`. This matches the output of
+	 * molstat::Simulator::simulateBatch.
+	 *
+	 * \throw std::runtime_error if the bins have already been formed.
+	 *
+	 * \param[in] v The data.
+	 * \param[in] n The number of data elements in the batch.
+	 * \param[in] ld The leading dimension of `v` (at least `n`).
+	 * \param[in] mask If not null, only elements `k` with `mask[k]` true are
+	 *    added.
+	 */
+	void add_data(const double *v, std::size_t n, std::size_t ld,
+		const bool *mask = nullptr);
+
+	/**
+	 * \brief Moves all of the data from another histogram into this one.
+	 *
+	 * This is used to combine partial histograms that were accumulated
+	 * independently (e.g., by different threads). `other` is left empty.
+	 *
+	 * \throw std::invalid_argument if the histograms have different
+	 *    dimensionalities, or if one is streaming and the other is not (or
+	 *    they have different bins).
+	 * \throw std::runtime_error if either histogram has already been binned.
+	 *
+	 * \param[in,out] other The histogram whose data is moved.
+	 */
+	void merge(Histogram &other);
+
 	/**
 	 * \brief Bins the data using the specified binning styles for each
 	 *    dimension.
 	 *
 	 * \throw std::invalid_argument if the number of binning styles doesn't
-	 *    match the dimensionality of the data.
+	 *    match the dimensionality of the data, or if there are too many bins.
 	 * \throw std::runtime_error if the histogram has already been binned, if
 	 *    one dimension doesn't specify a binning style, or if one dimension
 	 *    uses a binning style with 0 bins.
 	 * \throw std::size_t if a dimenion (its index is thrown) has a null data
 	 *    range (all values are the same) and more than one bin is requested.
 	 *
+	 * The chunks of stored data are divided among the threads; the first
+	 * thread bins its chunks directly into the histogram, each other thread
+	 * into its own set of counts, and the sets are summed at the end. For a
+	 * dense histogram, the other threads' counts together hold at most
+	 * max_dense_bins bins, so fewer threads are used for histograms with many
+	 * bins. The result does not depend on the number of threads.
+	 *
 	 * \param[in] binstyles The binning styles.
+	 * \param[in] nthreads The (maximum) number of threads to use.
 	 */
 	void bin_data(
-		const std::vector<std::shared_ptr<const BinStyle>> &binstyles);
+		const std::vector<std::shared_ptr<const BinStyle>> &binstyles,
+		std::size_t nthreads = 1);
+
+	/**
+	 * \brief Finishes binning a streaming histogram.
+	 *
+	 * \throw std::runtime_error if the histogram is not streaming or has
+	 *    already been binned.
+	 */
+	void bin_data();
+
+	/**
+	 * \brief Adds the bin counts of another (binned) histogram to this one.
+	 *
+	 * The histograms must have the same bins: the same dimensionality,
+	 * binning styles, and bounds. This is the case, for instance, for
+	 * streaming histograms with the same binning styles and ranges. The
+	 * underflow and overflow counts are also added.
+	 *
+	 * \throw std::runtime_error if either histogram has not been binned.
+	 * \throw std::invalid_argument if the histograms have different bins, or
+	 *    if one is streaming and the other is not.
+	 *
+	 * \param[in] other The other histogram.
+	 */
+	void accumulate(const Histogram &other);
+
+	/**
+	 * \brief Writes the (binned) histogram in a binary format.
+	 *
+	 * The format (version 1) is, with integers as 64-bit unsigned values
+	 * (except where noted) and all values in the machine's byte order:
+	 * -# The 8 characters `MOLSTATH`.
+	 * -# The format version (32-bit) and the value `0x01020304` (32-bit), to
+	 *    detect a different byte order.
+	 * -# The dimensionality, and the flags (8-bit): 1 if streaming, plus 2 if
+	 *    sparse.
+	 * -# For each dimension: the length of the binning style's
+	 *    molstat::BinStyle::factoryString() and its characters; the number of
+	 *    bins; the bounds (minimum, maximum, and bin width in masked
+	 *    coordinates); the extremes (unmasked); and the underflow and
+	 *    overflow counts.
+	 * -# The number of data elements outside the range.
+	 * -# The number of stored bins, `n`.
+	 * -# For a sparse histogram, the `n` offsets of the occupied bins (see
+	 *    molstat::CounterIndex::arrayOffset()), in increasing order.
+	 * -# The `n` bin counts (doubles).
+	 * .
+	 *
+	 * \throw std::runtime_error if the histogram has not been binned or if
+	 *    writing fails.
+	 *
+	 * \param[in,out] out The output stream (opened in binary mode).
+	 */
+	void serialize(std::ostream &out) const;
+
+	/**
+	 * \brief Reads a histogram written by serialize().
+	 *
+	 * The returned histogram is binned. Whether or not it is sparse is
+	 * determined by its number of bins, as for any histogram.
+	 *
+	 * \throw std::runtime_error if the stream does not contain a valid
+	 *    histogram (or has an unsupported version).
+	 *
+	 * \param[in,out] in The input stream (opened in binary mode).
+	 * \return The histogram.
+	 */
+	static std::unique_ptr<Histogram> deserialize(std::istream &in);
+
+	/**
+	 * \brief Gets the dimensionality of the data.
+	 *
+	 * \return The number of dimensions.
+	 */
+	std::size_t getDimensionality() const noexcept;
+
+	/**
+	 * \brief Gets the coordinates of the bins in one dimension.
+	 *
+	 * The coordinates of a bin are `getBinValues(j)[index[j]]` for each
+	 * dimension `j`; see getCoordinates().
+	 *
+	 * \throw std::runtime_error if the data has not yet been binned.
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The (unmasked) middle of each bin in the dimension.
+	 */
+	const std::vector<double> &getBinValues(std::size_t dim) const;
+
+	/**
+	 * \brief Determines if the histogram is streaming.
+	 *
+	 * \return True if data is binned as it is added.
+	 */
+	bool isStreaming() const noexcept;
+
+	/**
+	 * \brief Determines if the histogram is sparse.
+	 *
+	 * This is determined when the bins are set up: at construction for a
+	 * streaming histogram, and when binning otherwise.
+	 *
+	 * \return True if only the occupied bins are stored.
+	 */
+	bool isSparse() const noexcept;
+
+	/**
+	 * \brief Gets the number of data elements that were outside the range of
+	 *    a streaming histogram (in any dimension).
+	 *
+	 * \return The number of data elements that were not binned.
+	 */
+	std::size_t numOutside() const noexcept;
+
+	/**
+	 * \brief Gets the extremes of a dimension.
+	 *
+	 * For a streaming histogram, this is the range of the dimension;
+	 * otherwise, it is the minimum and maximum values of the data added so
+	 * far.
+	 *
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The minimum and maximum values.
+	 */
+	std::array<double, 2> getExtremes(std::size_t dim) const;
+
+	/**
+	 * \brief Gets the number of data elements below the range of a dimension.
+	 *
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The underflow count; always 0 if the histogram is not
+	 *    streaming.
+	 */
+	std::size_t getUnderflow(std::size_t dim) const;
+
+	/**
+	 * \brief Gets the number of data elements above the range of a dimension.
+	 *
+	 * \throw std::out_of_range if the dimension is invalid.
+	 *
+	 * \param[in] dim The dimension.
+	 * \return The overflow count; always 0 if the histogram is not
+	 *    streaming.
+	 */
+	std::size_t getOverflow(std::size_t dim) const;
 
 	/**
 	 * \brief Gets an index that iterates over all the bins.
 	 *
+	 * For a sparse histogram, the index iterates over only the occupied bins.
+	 *
 	 * \throw std::runtime_error if the data has not yet been binned.
 	 *
 	 * \return The iterator.
@@ -145,7 +524,8 @@ public:
 	 * \throw std::runtime_error if the data has not yet been binned.
 	 *
 	 * \param[in] index The index of the bin.
-	 * \return The bin count of the bin.
+	 * \return The bin count of the bin (0 for an unoccupied bin of a sparse
+	 *    histogram).
 	 */
 	double getBinCount(const CounterIndex &index) const;
 };
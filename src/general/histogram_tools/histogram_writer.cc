@@ -0,0 +1,96 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_writer.cc
+ * \brief Writes binned histograms as text.
+ */
+
+#include "histogram_writer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace molstat {
+
+constexpr std::size_t HistogramWriter::buffer_size;
+
+HistogramWriter::HistogramWriter(std::ostream &out_, const bool exact_)
+	: out(out_), exact(exact_), buffer()
+{
+}
+
+void HistogramWriter::appendNumber(std::string &str, const double x) const
+{
+	char number[32];
+	int length;
+
+	if(!exact)
+	{
+		// this is the default formatting of std::ostream
+		length = std::snprintf(number, sizeof(number), "%g", x);
+	}
+	else
+	{
+		// use the fewest digits (starting from 15) that reproduce the number;
+		// 17 always suffice
+		for(int digits = 15; ; ++digits)
+		{
+			length = std::snprintf(number, sizeof(number), "%.*g", digits, x);
+			if(digits == 17 || std::strtod(number, nullptr) == x)
+				break;
+		}
+	}
+
+	str.append(number, length);
+}
+
+void HistogramWriter::flush()
+{
+	out.write(buffer.data(), buffer.size());
+	buffer.clear();
+}
+
+void HistogramWriter::write(const Histogram &hist)
+{
+	// throws if the histogram hasn't been binned
+	CounterIndex ci{ hist.begin() };
+
+	// format the coordinates of each dimension
+	const std::size_t ndim{ hist.getDimensionality() };
+	std::vector<std::vector<std::string>> coords(ndim);
+	for(std::size_t j = 0; j < ndim; ++j)
+	{
+		const std::vector<double> &values = hist.getBinValues(j);
+		coords[j].resize(values.size());
+		for(std::size_t k = 0; k < values.size(); ++k)
+		{
+			appendNumber(coords[j][k], values[k]);
+			coords[j][k] += ' ';
+		}
+	}
+
+	// go through the bins
+	buffer.reserve(buffer_size + 256);
+	for(; !ci.at_end(); ++ci)
+	{
+		for(std::size_t j = 0; j < ndim; ++j)
+			buffer += coords[j][ci[j]];
+		appendNumber(buffer, hist.getBinCount(ci));
+		buffer += '\n';
+
+		if(buffer.size() >= buffer_size)
+			flush();
+	}
+
+	flush();
+	out.flush();
+
+	if(!out)
+		throw std::runtime_error("Unable to write the histogram.");
+}
+
+} // namespace molstat
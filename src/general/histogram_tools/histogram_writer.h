@@ -0,0 +1,87 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_writer.h
+ * \brief Writes binned histograms as text.
+ */
+
+#ifndef __histogram_writer_h__
+#define __histogram_writer_h__
+
+#include <iostream>
+#include <string>
+#include "histogram.h"
+
+namespace molstat {
+
+/**
+ * \brief Writes binned histograms as text, one bin per line.
+ *
+ * Each line contains the coordinates of the bin (one per dimension) and the
+ * bin count, separated by spaces. By default, the numbers are written as
+ * `std::ostream` writes them by default (6 significant digits). Optionally,
+ * every number can be written with the fewest digits (up to 17) that
+ * reproduce it exactly.
+ *
+ * The lines are assembled in a large buffer that is written to the output
+ * stream in a few large pieces, and the coordinates of the bins are formatted
+ * once per dimension (not once per bin).
+ */
+class HistogramWriter
+{
+private:
+	/// The output stream.
+	std::ostream &out;
+
+	/// True if the numbers are written with all the digits needed to
+	/// reproduce them.
+	const bool exact;
+
+	/// The output buffer.
+	std::string buffer;
+
+	/// The size at which the buffer is written to the output stream.
+	static constexpr std::size_t buffer_size = std::size_t(1) << 20;
+
+	/**
+	 * \brief Appends a number to a string.
+	 *
+	 * \param[in,out] str The string.
+	 * \param[in] x The number.
+	 */
+	void appendNumber(std::string &str, const double x) const;
+
+	/// Writes the buffer to the output stream and empties it.
+	void flush();
+
+public:
+	HistogramWriter() = delete;
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in,out] out_ The output stream.
+	 * \param[in] exact_ True if the numbers should be written with all the
+	 *    digits needed to reproduce them.
+	 */
+	HistogramWriter(std::ostream &out_, const bool exact_ = false);
+
+	/**
+	 * \brief Writes a histogram.
+	 *
+	 * For a sparse histogram, only the occupied bins are written.
+	 *
+	 * \throw std::runtime_error if the histogram has not been binned, or if
+	 *    writing fails.
+	 *
+	 * \param[in] hist The histogram.
+	 */
+	void write(const Histogram &hist);
+};
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,274 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_binning.cc
+ * \brief Bins the samples in a sample file into histograms.
+ */
+
+#include "sample_binning.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace molstat {
+
+/**
+ * \brief Processes the groups of a sample file with several threads.
+ *
+ * The threads take the groups in order, so that the file is read (nearly)
+ * sequentially. Each group is released after it is processed.
+ *
+ * \throw std::exception if an error occurs in any thread.
+ *
+ * \param[in] file The sample file.
+ * \param[in] nthreads The number of threads.
+ * \param[in] process The function that processes a group; its arguments are
+ *    the thread and the group.
+ */
+static void process_groups(const SampleFile &file, const std::size_t nthreads,
+	const std::function<void(std::size_t, std::size_t)> &process)
+{
+	std::atomic<std::size_t> next{ 0 };
+	std::vector<std::exception_ptr> errors(nthreads, nullptr);
+
+	auto worker = [&] (std::size_t thread) -> void
+	{
+		try
+		{
+			for(std::size_t g = next++; g < file.numGroups(); g = next++)
+			{
+				process(thread, g);
+				file.release(g);
+			}
+		}
+		catch(...)
+		{
+			errors[thread] = std::current_exception();
+
+			// stop the other threads
+			next = file.numGroups();
+		}
+	};
+
+	if(nthreads == 1)
+		worker(0);
+	else
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(nthreads);
+		for(std::size_t t = 0; t < nthreads; ++t)
+			workers.emplace_back(worker, t);
+
+		for(auto &t : workers)
+			t.join();
+	}
+
+	for(std::size_t t = 0; t < nthreads; ++t)
+	{
+		if(errors[t] != nullptr)
+			std::rethrow_exception(errors[t]);
+	}
+}
+
+/**
+ * \brief Flags the trials of a group that produced all of the observables.
+ *
+ * \param[in] file The sample file.
+ * \param[in] g The group.
+ * \param[out] produced Storage for the flag of each row in the group.
+ */
+static void produced_trials(const SampleFile &file, const std::size_t g,
+	bool *produced)
+{
+	const std::size_t n{ file.groupRows(g) };
+
+	for(std::size_t k = 0; k < n; ++k)
+		produced[k] = true;
+
+	for(std::size_t j = 0; j < file.numObservables(); ++j)
+	{
+		const double *column{ file.column(g, j) };
+		for(std::size_t k = 0; k < n; ++k)
+		{
+			if(std::isnan(column[k]))
+				produced[k] = false;
+		}
+	}
+}
+
+std::vector<std::unique_ptr<Histogram>> binSamples(const SampleFile &file,
+	const std::vector<SampleHistogramSpec> &specs, std::size_t nthreads)
+{
+	// check the specifications, and find the columns that need a range
+	std::vector<bool> need_range(file.numColumns(), false);
+	bool any_range{ false };
+	for(const SampleHistogramSpec &spec : specs)
+	{
+		if(spec.columns.size() == 0 || spec.styles.size() != spec.columns.size())
+			throw std::invalid_argument("Each histogram needs a binning style " \
+				"for each of its columns.");
+
+		if(spec.ranges.size() != 0 && spec.ranges.size() != spec.columns.size())
+			throw std::invalid_argument("A range must be specified for every " \
+				"column of a histogram or for none of them.");
+
+		for(std::size_t col : spec.columns)
+		{
+			if(col >= file.numColumns())
+				throw std::invalid_argument("The column is not in the sample file.");
+
+			if(spec.ranges.size() == 0)
+			{
+				need_range[col] = true;
+				any_range = true;
+			}
+		}
+	}
+
+	if(nthreads > file.numGroups())
+		nthreads = file.numGroups();
+	if(nthreads == 0)
+		nthreads = 1;
+
+	// the range of the data (of the produced trials) in each column that
+	// needs one
+	std::vector<std::array<double, 2>> extremes(file.numColumns(),
+		{{ std::numeric_limits<double>::max(),
+		   -std::numeric_limits<double>::max() }});
+	if(any_range)
+	{
+		std::vector<std::vector<std::array<double, 2>>> partial(nthreads,
+			extremes);
+		std::vector<std::unique_ptr<bool[]>> produced(nthreads);
+		for(auto &p : produced)
+			p.reset(new bool[file.rowsPerGroup()]);
+
+		process_groups(file, nthreads,
+			[&] (std::size_t thread, std::size_t g) -> void
+			{
+				const std::size_t n{ file.groupRows(g) };
+				bool *mask{ produced[thread].get() };
+				produced_trials(file, g, mask);
+
+				for(std::size_t j = 0; j < file.numColumns(); ++j)
+				{
+					if(!need_range[j])
+						continue;
+
+					const double *column{ file.column(g, j) };
+					std::array<double, 2> &ext = partial[thread][j];
+					for(std::size_t k = 0; k < n; ++k)
+					{
+						if(!mask[k])
+							continue;
+
+						if(column[k] < ext[0])
+							ext[0] = column[k];
+						if(column[k] > ext[1])
+							ext[1] = column[k];
+					}
+				}
+			});
+
+		for(std::size_t t = 0; t < nthreads; ++t)
+		{
+			for(std::size_t j = 0; j < file.numColumns(); ++j)
+			{
+				if(partial[t][j][0] < extremes[j][0])
+					extremes[j][0] = partial[t][j][0];
+				if(partial[t][j][1] > extremes[j][1])
+					extremes[j][1] = partial[t][j][1];
+			}
+		}
+
+		for(std::size_t j = 0; j < file.numColumns(); ++j)
+		{
+			if(need_range[j] && !(extremes[j][0] < extremes[j][1]))
+				throw std::invalid_argument("The data in column \"" +
+					file.columnName(j) + "\" does not have a range; specify one.");
+		}
+	}
+
+	// make the (empty) histograms
+	std::vector<std::unique_ptr<Histogram>> ret;
+	ret.reserve(specs.size());
+	for(const SampleHistogramSpec &spec : specs)
+	{
+		std::vector<std::array<double, 2>> ranges{ spec.ranges };
+		if(ranges.size() == 0)
+		{
+			for(std::size_t col : spec.columns)
+				ranges.push_back(extremes[col]);
+		}
+
+		ret.emplace_back(new Histogram(spec.styles, ranges));
+	}
+
+	// bin the data; each thread has its own partial histograms, and copies
+	// the columns of a histogram unless they are consecutive in the file
+	std::vector<std::vector<Histogram>> partials(nthreads);
+	std::vector<std::unique_ptr<bool[]>> produced(nthreads);
+	std::vector<std::vector<double>> scratch(nthreads);
+	for(std::size_t t = 0; t < nthreads; ++t)
+	{
+		for(const auto &hist : ret)
+			partials[t].push_back(*hist);
+		produced[t].reset(new bool[file.rowsPerGroup()]);
+	}
+
+	process_groups(file, nthreads,
+		[&] (std::size_t thread, std::size_t g) -> void
+		{
+			const std::size_t n{ file.groupRows(g) };
+			bool *mask{ produced[thread].get() };
+			produced_trials(file, g, mask);
+
+			for(std::size_t h = 0; h < specs.size(); ++h)
+			{
+				const std::vector<std::size_t> &columns = specs[h].columns;
+
+				bool consecutive{ true };
+				for(std::size_t j = 1; j < columns.size(); ++j)
+					consecutive = consecutive && (columns[j] == columns[0] + j);
+
+				if(consecutive)
+				{
+					partials[thread][h].add_data(file.column(g, columns[0]), n,
+						file.rowsPerGroup(), mask);
+				}
+				else
+				{
+					std::vector<double> &data = scratch[thread];
+					data.resize(columns.size() * n);
+					for(std::size_t j = 0; j < columns.size(); ++j)
+					{
+						const double *column{ file.column(g, columns[j]) };
+						std::copy(column, column + n, data.begin() + j * n);
+					}
+
+					partials[thread][h].add_data(data.data(), n, n, mask);
+				}
+			}
+		});
+
+	for(std::size_t h = 0; h < ret.size(); ++h)
+	{
+		for(std::size_t t = 0; t < nthreads; ++t)
+			ret[h]->merge(partials[t][h]);
+
+		ret[h]->bin_data();
+	}
+
+	return ret;
+}
+
+} // namespace molstat
@@ -0,0 +1,70 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_binning.h
+ * \brief Bins the samples in a sample file into histograms.
+ */
+
+#ifndef __sample_binning_h__
+#define __sample_binning_h__
+
+#include <array>
+#include <memory>
+#include <vector>
+#include "histogram.h"
+#include "bin_style.h"
+#include "sample_file.h"
+
+namespace molstat {
+
+/**
+ * \brief Describes a histogram to be made from the columns of a sample file.
+ */
+struct SampleHistogramSpec
+{
+	/// The column of the sample file used for each dimension.
+	std::vector<std::size_t> columns;
+
+	/// The binning style of each dimension.
+	std::vector<std::shared_ptr<const BinStyle>> styles;
+
+	/**
+	 * \brief The range of each dimension, or an empty vector for the range
+	 *    of the data.
+	 */
+	std::vector<std::array<double, 2>> ranges;
+};
+
+/**
+ * \brief Bins the samples in a sample file into several histograms.
+ *
+ * Only the trials that produced all of the observables (none of the file's
+ * observable columns is NaN) are binned, as in `molstat-simulator`. Every
+ * histogram is binned as the data is read (see the streaming constructor of
+ * molstat::Histogram), so the memory needed does not depend on the size of
+ * the file:
+ * - If every histogram has ranges, the file is read once. The groups of the
+ *   file are processed in order by several threads (each with its own
+ *   partial histograms), and each group is released once it is binned.
+ * - Otherwise, the file is first read to find the range of the data in each
+ *   column that needs one. The histograms are then the same as those
+ *   `molstat-simulator` makes without a range.
+ *
+ * \throw std::invalid_argument if a specification is inconsistent (e.g., a
+ *    column is not in the file), or if the data in a column without a range
+ *    does not have a range (no trials, or every trial has the same value).
+ *
+ * \param[in] file The sample file.
+ * \param[in] specs The histograms.
+ * \param[in] nthreads The (maximum) number of threads to use.
+ * \return The (binned) histograms, in the same order as `specs`.
+ */
+std::vector<std::unique_ptr<Histogram>> binSamples(const SampleFile &file,
+	const std::vector<SampleHistogramSpec> &specs, std::size_t nthreads = 1);
+
+} // namespace molstat
+
+#endif
@@ -0,0 +1,431 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_file.cc
+ * \brief Implements the reader and writer for sample files.
+ */
+
+#include <config.h>
+#include "sample_file.h"
+#include <general/string_tools.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#if HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace molstat {
+
+constexpr std::size_t SampleWriter::default_rows_per_group;
+
+/// The identifier at the beginning of a sample file.
+static const char sample_magic[8] = { 'M', 'O', 'L', 'S', 'T', 'A', 'T', 'S' };
+
+/// The version of the sample file format.
+static constexpr std::uint32_t sample_version = 1;
+
+/// The byte-order mark of a sample file.
+static constexpr std::uint32_t sample_byte_order = 0x01020304;
+
+/// The alignment of the header size and the group buffers (a page).
+static constexpr std::size_t sample_alignment = 4096;
+
+SampleWriter::SampleWriter(const std::string &filename,
+	const std::vector<std::string> &names, std::size_t nobservables,
+	std::size_t nrows_, std::size_t rows_per_group_)
+	: out(), ncolumns(names.size()), nrows(nrows_),
+	  rows_per_group(rows_per_group_), header_size(0), pending(), spare(),
+	  written(), failed(false)
+{
+	if(ncolumns == 0)
+		throw std::invalid_argument("A sample file needs at least one column.");
+
+	if(nobservables > ncolumns)
+		throw std::invalid_argument("More observables than columns.");
+
+	if(rows_per_group == 0 ||
+		(rows_per_group * sizeof(double)) % sample_alignment != 0)
+	{
+		throw std::invalid_argument("The number of rows in each group must be " \
+			"a positive multiple of 512.");
+	}
+
+	out.open(filename, std::ios_base::binary | std::ios_base::trunc);
+	if(!out)
+		throw std::runtime_error("Unable to open \"" + filename +
+			"\" for output.");
+
+	// assemble the header; its size is rounded up to a page
+	header_size = sizeof(SampleFileHeader) + ncolumns * sample_name_length;
+	header_size = (header_size + sample_alignment - 1) / sample_alignment *
+		sample_alignment;
+
+	std::vector<char> bytes(header_size, '\0');
+
+	SampleFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, sample_magic, sizeof(header.magic));
+	header.version = sample_version;
+	header.byte_order = sample_byte_order;
+	header.ncolumns = ncolumns;
+	header.nobservables = nobservables;
+	header.nrows = nrows;
+	header.rows_per_group = rows_per_group;
+	header.header_size = header_size;
+	std::memcpy(bytes.data(), &header, sizeof(header));
+
+	for(std::size_t j = 0; j < ncolumns; ++j)
+		names[j].copy(bytes.data() + sizeof(header) + j * sample_name_length,
+			sample_name_length - 1);
+
+	out.write(bytes.data(), bytes.size());
+	if(!out)
+		throw std::runtime_error("Unable to write the sample file.");
+
+	written.assign((nrows + rows_per_group - 1) / rows_per_group, false);
+}
+
+SampleWriter::Group SampleWriter::newGroup()
+{
+	Group ret;
+
+	if(spare.size() > 0)
+	{
+		ret = std::move(spare.back());
+		spare.pop_back();
+	}
+	else
+	{
+		// over-allocate so that the data can start on a page boundary
+		const std::size_t bytes{ ncolumns * rows_per_group * sizeof(double) };
+		ret.storage.resize((bytes + sample_alignment) / sizeof(double));
+
+		void *ptr{ ret.storage.data() };
+		std::size_t space{ ret.storage.size() * sizeof(double) };
+		ret.data = static_cast<double*>(
+			std::align(sample_alignment, bytes, ptr, space));
+	}
+
+	std::fill(ret.data, ret.data + ncolumns * rows_per_group,
+		std::numeric_limits<double>::quiet_NaN());
+	ret.filled = 0;
+
+	return ret;
+}
+
+void SampleWriter::writeGroup(std::size_t g, const Group &group)
+{
+	std::lock_guard<std::mutex> lock(file_mutex);
+
+	const std::size_t bytes{ ncolumns * rows_per_group * sizeof(double) };
+	out.seekp(header_size + g * bytes);
+	out.write(reinterpret_cast<const char*>(group.data), bytes);
+
+	if(!out)
+		throw std::runtime_error("Unable to write the sample file.");
+}
+
+void SampleWriter::write(std::size_t first, std::size_t n,
+	const double *columns, std::size_t stride)
+{
+	if(n > nrows || first > nrows - n)
+		throw std::out_of_range("The rows are not in the sample file.");
+
+	std::size_t done{ 0 };
+	while(done < n)
+	{
+		const std::size_t row{ first + done };
+		const std::size_t g{ row / rows_per_group };
+		const std::size_t start{ row % rows_per_group };
+		const std::size_t m{ std::min(n - done, rows_per_group - start) };
+
+		// find (or start) the group; the group stays in place while other
+		// groups are added or removed, and only this call supplies these
+		// rows, so the copy does not need the lock
+		Group *group;
+		{
+			std::lock_guard<std::mutex> lock(groups_mutex);
+			if(failed)
+				throw std::runtime_error("Unable to write the sample file.");
+
+			auto iter = pending.find(g);
+			if(iter == pending.end())
+				iter = pending.emplace(g, newGroup()).first;
+			group = &iter->second;
+		}
+
+		for(std::size_t j = 0; j < ncolumns; ++j)
+			std::copy(columns + j * stride + done, columns + j * stride + done + m,
+				group->data + j * rows_per_group + start);
+
+		// write the group if it is complete
+		Group complete;
+		bool full;
+		{
+			std::lock_guard<std::mutex> lock(groups_mutex);
+			group->filled += m;
+			full = (group->filled ==
+				std::min(rows_per_group, nrows - g * rows_per_group));
+			if(full)
+			{
+				complete = std::move(*group);
+				pending.erase(g);
+			}
+		}
+
+		if(full)
+		{
+			try
+			{
+				writeGroup(g, complete);
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock(groups_mutex);
+				failed = true;
+				throw;
+			}
+
+			std::lock_guard<std::mutex> lock(groups_mutex);
+			written[g] = true;
+			spare.emplace_back(std::move(complete));
+		}
+
+		done += m;
+	}
+}
+
+SampleWriter::~SampleWriter()
+{
+	try
+	{
+		close();
+	}
+	catch(...)
+	{
+	}
+}
+
+void SampleWriter::close()
+{
+	std::lock_guard<std::mutex> lock(groups_mutex);
+
+	if(!out.is_open())
+		return;
+
+	if(failed)
+		throw std::runtime_error("Unable to write the sample file.");
+
+	// write the partially filled groups, and any groups that were never
+	// started (all NaN)
+	for(std::size_t g = 0; g < written.size(); ++g)
+	{
+		if(written[g])
+			continue;
+
+		auto iter = pending.find(g);
+		if(iter != pending.end())
+		{
+			writeGroup(g, iter->second);
+			pending.erase(iter);
+		}
+		else
+			writeGroup(g, newGroup());
+
+		written[g] = true;
+	}
+
+	out.close();
+	if(!out)
+		throw std::runtime_error("Unable to write the sample file.");
+}
+
+SampleFile::SampleFile(const std::string &filename)
+	: contents(nullptr), size(0), mapped(false), buffer(), header(nullptr)
+{
+#if HAVE_SYS_MMAN_H
+	const int fd{ ::open(filename.c_str(), O_RDONLY) };
+	if(fd < 0)
+		throw std::runtime_error("Unable to open \"" + filename + "\".");
+
+	struct stat info;
+	if(::fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error("Unable to open \"" + filename + "\".");
+	}
+	size = info.st_size;
+
+	if(size >= sizeof(SampleFileHeader))
+	{
+		void *map{ ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) };
+		if(map != MAP_FAILED)
+		{
+			contents = static_cast<const char*>(map);
+			mapped = true;
+
+			// the groups are usually read in order
+			::madvise(map, size, MADV_SEQUENTIAL);
+		}
+	}
+	::close(fd);
+#endif
+
+	// read the file if it could not be mapped
+	if(!mapped)
+	{
+		std::ifstream in(filename, std::ios_base::binary | std::ios_base::ate);
+		if(!in)
+			throw std::runtime_error("Unable to open \"" + filename + "\".");
+
+		size = in.tellg();
+		buffer.resize((size + sizeof(double) - 1) / sizeof(double));
+		in.seekg(0);
+		if(!in.read(reinterpret_cast<char*>(buffer.data()), size))
+			throw std::runtime_error("Unable to read \"" + filename + "\".");
+
+		contents = reinterpret_cast<const char*>(buffer.data());
+	}
+
+	// check the header
+	header = reinterpret_cast<const SampleFileHeader*>(contents);
+	const char *error{ nullptr };
+
+	if(size < sizeof(SampleFileHeader) ||
+		std::memcmp(header->magic, sample_magic, sizeof(sample_magic)) != 0)
+	{
+		error = "Not a sample file.";
+	}
+	else if(header->byte_order != sample_byte_order)
+		error = "The sample file has a different byte order.";
+	else if(header->version != sample_version)
+		error = "Unsupported version of the sample file format.";
+	else if(header->ncolumns == 0 ||
+		header->nobservables > header->ncolumns ||
+		header->rows_per_group == 0 ||
+		header->header_size % sample_alignment != 0 ||
+		header->ncolumns > size / sample_name_length ||
+		header->header_size < sizeof(SampleFileHeader) +
+			header->ncolumns * sample_name_length ||
+		header->header_size > size)
+	{
+		error = "Corrupt sample file header.";
+	}
+	else
+	{
+		// the groups must fit in the file
+		const std::size_t fit{ (size - header->header_size) /
+			header->ncolumns / header->rows_per_group / sizeof(double) };
+		if(numGroups() > fit)
+			error = "The sample file is truncated.";
+	}
+
+	if(error != nullptr)
+	{
+#if HAVE_SYS_MMAN_H
+		if(mapped)
+			::munmap(const_cast<char*>(contents), size);
+#endif
+		throw std::runtime_error("\"" + filename + "\": " + error);
+	}
+}
+
+SampleFile::~SampleFile()
+{
+#if HAVE_SYS_MMAN_H
+	if(mapped)
+		::munmap(const_cast<char*>(contents), size);
+#endif
+}
+
+std::size_t SampleFile::numColumns() const noexcept
+{
+	return header->ncolumns;
+}
+
+std::size_t SampleFile::numObservables() const noexcept
+{
+	return header->nobservables;
+}
+
+std::size_t SampleFile::numRows() const noexcept
+{
+	return header->nrows;
+}
+
+std::size_t SampleFile::rowsPerGroup() const noexcept
+{
+	return header->rows_per_group;
+}
+
+std::size_t SampleFile::numGroups() const noexcept
+{
+	return (header->nrows + header->rows_per_group - 1) /
+		header->rows_per_group;
+}
+
+std::size_t SampleFile::groupRows(std::size_t g) const noexcept
+{
+	return std::min<std::size_t>(header->rows_per_group,
+		header->nrows - g * header->rows_per_group);
+}
+
+std::string SampleFile::columnName(std::size_t j) const
+{
+	if(j >= header->ncolumns)
+		throw std::out_of_range("The column is not in the sample file.");
+
+	const char *name{ contents + sizeof(SampleFileHeader) +
+		j * sample_name_length };
+
+	return std::string(name, strnlen(name, sample_name_length));
+}
+
+const double *SampleFile::column(std::size_t g, std::size_t j) const
+{
+	if(g >= numGroups() || j >= header->ncolumns)
+		throw std::out_of_range("The column is not in the sample file.");
+
+	return reinterpret_cast<const double*>(contents + header->header_size) +
+		(g * header->ncolumns + j) * header->rows_per_group;
+}
+
+std::size_t SampleFile::findColumn(const std::string &name) const
+{
+	const std::string lower{ to_lower(name) };
+
+	for(std::size_t j = 0; j < header->ncolumns; ++j)
+	{
+		if(to_lower(columnName(j)) == lower)
+			return j;
+	}
+
+	throw std::out_of_range("No column named \"" + name + "\".");
+}
+
+void SampleFile::release(std::size_t g) const noexcept
+{
+#if HAVE_SYS_MMAN_H
+	if(mapped && g < numGroups())
+	{
+		const std::size_t bytes{ header->ncolumns * header->rows_per_group *
+			sizeof(double) };
+
+		// the groups are page-aligned, so the advice covers exactly the group
+		::madvise(const_cast<char*>(contents) + header->header_size + g * bytes,
+			bytes, MADV_DONTNEED);
+	}
+#endif
+}
+
+} // namespace molstat
@@ -0,0 +1,356 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_file.h
+ * \brief Files of raw (unbinned) samples in a columnar, binary format.
+ *
+ * A sample file stores a table of doubles: one row per trial and one column
+ * per quantity (the observables, possibly followed by the model parameters).
+ * The file is designed to be memory-mapped and used without parsing:
+ * - A header of molstat::SampleFileHeader::header_size bytes (a multiple of
+ *   4096) starts the file. It is a molstat::SampleFileHeader, followed by
+ *   the name of each column in a fixed field of
+ *   molstat::sample_name_length bytes (padded with null characters).
+ * - The rows are stored in groups of `rows_per_group` rows. Within a group,
+ *   each column is contiguous. Column `j` of group `g` thus starts
+ *   `header_size + (g * ncolumns + j) * rows_per_group * sizeof(double)`
+ *   bytes into the file, which is page-aligned.
+ * - The last group is padded to `rows_per_group` rows with NaN.
+ *
+ * All numbers are stored in the native byte order; the header records the
+ * byte order so that a mismatch is detected.
+ */
+
+#ifndef __sample_file_h__
+#define __sample_file_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace molstat {
+
+/// The number of bytes reserved for each column name in a sample file.
+constexpr std::size_t sample_name_length = 64;
+
+/**
+ * \brief The fixed-size header at the beginning of a sample file.
+ *
+ * See sample_file.h for a description of the file format.
+ */
+struct SampleFileHeader
+{
+	/// The file identifier, "MOLSTATS".
+	char magic[8];
+
+	/// The version of the file format.
+	std::uint32_t version;
+
+	/// The value 0x01020304, for detecting the byte order.
+	std::uint32_t byte_order;
+
+	/// The number of columns.
+	std::uint64_t ncolumns;
+
+	/// The number of columns (at the beginning) that are observables.
+	std::uint64_t nobservables;
+
+	/// The number of rows (trials).
+	std::uint64_t nrows;
+
+	/// The number of rows in each group.
+	std::uint64_t rows_per_group;
+
+	/// The number of bytes before the first group.
+	std::uint64_t header_size;
+
+	/// Reserved; zero.
+	std::uint64_t reserved;
+};
+
+/**
+ * \brief Writes a sample file.
+ *
+ * The number of rows is specified up front, and the rows may be supplied in
+ * any order (and from several threads). Rows are collected in page-aligned
+ * buffers, one per group, and each group is written with one large write
+ * once all of its rows have arrived. Only the groups that are partially
+ * filled are held in memory.
+ */
+class SampleWriter
+{
+private:
+	/// A group of rows that is being collected.
+	struct Group
+	{
+		/// Storage for the group; `data` points into it.
+		std::vector<double> storage;
+
+		/// The (aligned) data of the group, one column after another.
+		double *data;
+
+		/// The number of rows of the group that have been supplied.
+		std::size_t filled;
+	};
+
+	/// The output file.
+	std::ofstream out;
+
+	/// The number of columns.
+	const std::size_t ncolumns;
+
+	/// The number of rows.
+	const std::size_t nrows;
+
+	/// The number of rows in each group.
+	const std::size_t rows_per_group;
+
+	/// The number of bytes before the first group.
+	std::size_t header_size;
+
+	/// The groups that have been started but not written.
+	std::map<std::size_t, Group> pending;
+
+	/// Buffers of groups that have been written, for reuse.
+	std::vector<Group> spare;
+
+	/// True for each group that has been written.
+	std::vector<bool> written;
+
+	/// True if an error has occurred.
+	bool failed;
+
+	/// Protects the groups.
+	std::mutex groups_mutex;
+
+	/// Protects the output file.
+	std::mutex file_mutex;
+
+	/**
+	 * \brief Gets a buffer for a new group.
+	 *
+	 * Must be called with `groups_mutex` held.
+	 *
+	 * \return The group, filled with NaN.
+	 */
+	Group newGroup();
+
+	/**
+	 * \brief Writes a group to the file.
+	 *
+	 * \param[in] g The index of the group.
+	 * \param[in] group The group.
+	 */
+	void writeGroup(std::size_t g, const Group &group);
+
+public:
+	/// The default number of rows in each group.
+	static constexpr std::size_t default_rows_per_group = 16384;
+
+	SampleWriter() = delete;
+	SampleWriter(const SampleWriter &) = delete;
+	SampleWriter &operator=(const SampleWriter &) = delete;
+
+	/**
+	 * \brief Creates a sample file and writes its header.
+	 *
+	 * \throw std::invalid_argument if there are no columns, the number of
+	 *    observables exceeds the number of columns, or `rows_per_group` is
+	 *    not a positive multiple of 512 (so that every column of every group
+	 *    is page-aligned).
+	 * \throw std::runtime_error if the file cannot be created.
+	 *
+	 * \param[in] filename The name of the file.
+	 * \param[in] names The name of each column; names longer than
+	 *    molstat::sample_name_length - 1 characters are truncated.
+	 * \param[in] nobservables The number of columns (at the beginning) that
+	 *    are observables.
+	 * \param[in] nrows_ The number of rows.
+	 * \param[in] rows_per_group_ The number of rows in each group.
+	 */
+	SampleWriter(const std::string &filename,
+		const std::vector<std::string> &names, std::size_t nobservables,
+		std::size_t nrows_,
+		std::size_t rows_per_group_ = default_rows_per_group);
+
+	/**
+	 * \brief Closes the file, if close() has not been called.
+	 *
+	 * Errors are ignored; call close() to detect them.
+	 */
+	~SampleWriter();
+
+	/**
+	 * \brief Supplies rows of the table.
+	 *
+	 * Column `j` of row `first + k` is `columns[j * stride + k]`. This
+	 * function may be called concurrently from several threads, as long as
+	 * each row is supplied once.
+	 *
+	 * \throw std::out_of_range if the rows are not in the table.
+	 * \throw std::runtime_error if writing to the file fails.
+	 *
+	 * \param[in] first The first row.
+	 * \param[in] n The number of rows.
+	 * \param[in] columns The data of the rows.
+	 * \param[in] stride The distance between the columns in `columns`.
+	 */
+	void write(std::size_t first, std::size_t n, const double *columns,
+		std::size_t stride);
+
+	/**
+	 * \brief Writes any remaining groups and closes the file.
+	 *
+	 * Rows that were not supplied are NaN.
+	 *
+	 * \throw std::runtime_error if writing to the file fails.
+	 */
+	void close();
+};
+
+/**
+ * \brief Read-only access to a sample file.
+ *
+ * The file is memory-mapped (where available), so the columns can be used
+ * directly, and only the parts of the file that are used are read from disk.
+ * The file is expected to be read (mostly) in order.
+ */
+class SampleFile
+{
+private:
+	/// The contents of the file.
+	const char *contents;
+
+	/// The size of the file, in bytes.
+	std::size_t size;
+
+	/// True if the contents are memory-mapped (as opposed to stored in
+	/// `buffer`).
+	bool mapped;
+
+	/// The contents of the file when memory mapping is not available.
+	std::vector<double> buffer;
+
+	/// The header.
+	const SampleFileHeader *header;
+
+public:
+	SampleFile() = delete;
+	SampleFile(const SampleFile &) = delete;
+	SampleFile &operator=(const SampleFile &) = delete;
+
+	/**
+	 * \brief Opens a sample file.
+	 *
+	 * \throw std::runtime_error if the file cannot be opened, or is not a
+	 *    sample file (in the native byte order).
+	 *
+	 * \param[in] filename The name of the file.
+	 */
+	SampleFile(const std::string &filename);
+
+	/// Releases the file.
+	~SampleFile();
+
+	/**
+	 * \brief Gets the number of columns.
+	 *
+	 * \return The number of columns.
+	 */
+	std::size_t numColumns() const noexcept;
+
+	/**
+	 * \brief Gets the number of columns (at the beginning) that are
+	 *    observables.
+	 *
+	 * \return The number of observables.
+	 */
+	std::size_t numObservables() const noexcept;
+
+	/**
+	 * \brief Gets the number of rows.
+	 *
+	 * \return The number of rows.
+	 */
+	std::size_t numRows() const noexcept;
+
+	/**
+	 * \brief Gets the number of rows in each group.
+	 *
+	 * \return The number of rows in each group.
+	 */
+	std::size_t rowsPerGroup() const noexcept;
+
+	/**
+	 * \brief Gets the number of groups.
+	 *
+	 * \return The number of groups.
+	 */
+	std::size_t numGroups() const noexcept;
+
+	/**
+	 * \brief Gets the number of (actual) rows in a group.
+	 *
+	 * \param[in] g The group.
+	 * \return The number of rows; this is rowsPerGroup() except, possibly,
+	 *    for the last group.
+	 */
+	std::size_t groupRows(std::size_t g) const noexcept;
+
+	/**
+	 * \brief Gets the name of a column.
+	 *
+	 * \throw std::out_of_range if the column does not exist.
+	 *
+	 * \param[in] j The column.
+	 * \return The name.
+	 */
+	std::string columnName(std::size_t j) const;
+
+	/**
+	 * \brief Gets the data of a column in a group.
+	 *
+	 * The data for each group is stored column by column, so the columns of
+	 * a group are contiguous: column `j + 1` immediately follows column `j`
+	 * (at a distance of rowsPerGroup()).
+	 *
+	 * \throw std::out_of_range if the group or column does not exist.
+	 *
+	 * \param[in] g The group.
+	 * \param[in] j The column.
+	 * \return The groupRows(g) values of the column.
+	 */
+	const double *column(std::size_t g, std::size_t j) const;
+
+	/**
+	 * \brief Finds a column by name.
+	 *
+	 * \throw std::out_of_range if there is no column with the name.
+	 *
+	 * \param[in] name The name of the column (case-insensitive).
+	 * \return The index of the (first) column with the name.
+	 */
+	std::size_t findColumn(const std::string &name) const;
+
+	/**
+	 * \brief Indicates that the data of a group is no longer needed.
+	 *
+	 * The memory holding the group may be reclaimed; the group is read from
+	 * the file again if it is used later. Releasing the groups after they are
+	 * processed lets files larger than the memory be processed.
+	 *
+	 * \param[in] g The group.
+	 */
+	void release(std::size_t g) const noexcept;
+};
+
+} // namespace molstat
+
+#endif
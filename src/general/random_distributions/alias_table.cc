@@ -0,0 +1,76 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file alias_table.cc
+ * \brief Implementation of Walker's alias method.
+ */
+
+#include "alias_table.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace molstat {
+
+AliasTable::AliasTable(const std::vector<double> &weights)
+	: prob(weights.size()), alias(weights.size())
+{
+	const std::size_t n{ weights.size() };
+	if(n == 0)
+		throw std::invalid_argument("At least one weight is needed.");
+
+	double total{ 0. };
+	for(double w : weights)
+	{
+		if(!(w >= 0.) || !std::isfinite(w))
+			throw std::invalid_argument("The weights must be non-negative.");
+		total += w;
+	}
+	if(!(total > 0.))
+		throw std::invalid_argument("At least one weight must be positive.");
+
+	// Vose's construction: scale the weights to an average of 1, and pair
+	// each column below 1 with one above 1
+	std::vector<double> scaled(n);
+	std::vector<std::size_t> small, large;
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		scaled[j] = weights[j] * n / total;
+		if(scaled[j] < 1.)
+			small.push_back(j);
+		else
+			large.push_back(j);
+	}
+
+	while(!small.empty() && !large.empty())
+	{
+		const std::size_t s{ small.back() }, l{ large.back() };
+		small.pop_back();
+		large.pop_back();
+
+		prob[s] = scaled[s];
+		alias[s] = l;
+
+		scaled[l] = (scaled[l] + scaled[s]) - 1.;
+		if(scaled[l] < 1.)
+			small.push_back(l);
+		else
+			large.push_back(l);
+	}
+
+	// the remaining columns are full (up to roundoff)
+	for(std::size_t j : large)
+	{
+		prob[j] = 1.;
+		alias[j] = j;
+	}
+	for(std::size_t j : small)
+	{
+		prob[j] = 1.;
+		alias[j] = j;
+	}
+}
+
+} // namespace molstat
@@ -0,0 +1,93 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file alias_table.h
+ * \brief Walker's alias method for sampling from a discrete distribution.
+ */
+
+#ifndef __alias_table_h__
+#define __alias_table_h__
+
+#include <cstddef>
+#include <vector>
+
+namespace molstat {
+
+/**
+ * \brief Table for sampling an index from a discrete distribution in O(1)
+ *    operations with Walker's alias method.
+ *
+ * The table is built once (Vose's O(n) construction). Each column holds an
+ * acceptance probability and an alias: a uniform random number chooses a
+ * column and decides between the column and its alias.
+ */
+class AliasTable
+{
+protected:
+	/// The probability of keeping each column (instead of its alias).
+	std::vector<double> prob;
+
+	/// The alias of each column.
+	std::vector<std::size_t> alias;
+
+public:
+	/// Creates an empty table.
+	AliasTable() = default;
+
+	/**
+	 * \brief Constructor specifying the (unnormalized) weights.
+	 *
+	 * \throw std::invalid_argument if there are no weights, if a weight is
+	 *    negative (or not finite), or if all of the weights are zero.
+	 *
+	 * \param[in] weights The weight of each index.
+	 */
+	explicit AliasTable(const std::vector<double> &weights);
+
+	/**
+	 * \brief Gets the number of indices.
+	 *
+	 * \return The number of indices.
+	 */
+	std::size_t size() const noexcept
+	{
+		return prob.size();
+	}
+
+	/**
+	 * \brief Chooses an index from a uniform random number.
+	 *
+	 * The bits of `u` that are not needed to choose the index are returned
+	 * in `within`, which is uniform in [0, 1) given the index. A sample from
+	 * within the chosen bin thus needs no additional random number.
+	 *
+	 * \param[in] u A uniform random number in [0, 1).
+	 * \param[out] within A uniform random number in [0, 1), independent of
+	 *    the index.
+	 * \return The index.
+	 */
+	std::size_t sample(const double u, double &within) const
+	{
+		const double x{ u * prob.size() };
+		std::size_t i{ static_cast<std::size_t>(x) };
+		if(i >= prob.size()) // guard against rounding
+			i = prob.size() - 1;
+		const double r{ x - i };
+
+		if(r < prob[i])
+		{
+			within = r / prob[i];
+			return i;
+		}
+
+		within = (r - prob[i]) / (1. - prob[i]);
+		return alias[i];
+	}
+};
+
+} // namespace molstat
+
+#endif
@@ -12,6 +12,7 @@
  */
 
 #include "constant.h"
+#include <algorithm>
 
 namespace molstat {
 
@@ -25,6 +26,12 @@ double ConstantDistribution::sample(Engine &engine) const
 	return value;
 }
 
+void ConstantDistribution::sampleN(Engine &engine, double *out,
+	std::size_t n) const
+{
+	std::fill(out, out + n, value);
+}
+
 std::string ConstantDistribution::info() const
 {
 	return "Constant = " + std::to_string(value) + ".";
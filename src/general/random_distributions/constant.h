@@ -46,6 +46,9 @@ public:
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const
+		override;
+
 	virtual std::string info() const override;
 };
 
@@ -0,0 +1,178 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file empirical.cc
+ * \brief Implementation of the empirical distribution.
+ */
+
+#include "empirical.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <general/string_tools.h>
+
+namespace molstat {
+
+EmpiricalDistribution::EmpiricalDistribution(
+	const std::vector<double> &centers, const std::vector<double> &weights)
+	: RandomDistribution(), source("tabulated histogram")
+{
+	setHistogram(centers, weights);
+}
+
+EmpiricalDistribution::EmpiricalDistribution(
+	const std::vector<double> &samples)
+	: RandomDistribution(), source("tabulated samples")
+{
+	setSamples(samples);
+}
+
+EmpiricalDistribution::EmpiricalDistribution(const std::string &filename)
+	: RandomDistribution(), source(filename)
+{
+	std::ifstream file(filename);
+	if(!file)
+		throw std::invalid_argument("Empirical Distribution: Unable to open \"" +
+			filename + "\".");
+
+	std::vector<double> first, second;
+	std::size_t ncolumns{ 0 }, lineno{ 0 };
+
+	for(std::string line; std::getline(file, line);)
+	{
+		++lineno;
+
+		TokenContainer tokens{ tokenize(line) };
+		if(tokens.size() == 0 || tokens.front()[0] == '#')
+			continue;
+
+		if(ncolumns == 0)
+		{
+			ncolumns = tokens.size();
+			if(ncolumns > 2)
+				throw std::invalid_argument("Empirical Distribution: Each line " \
+					"of \"" + filename + "\" must have a bin center and weight, " \
+					"or a sample.");
+		}
+		else if(tokens.size() != ncolumns)
+			throw std::invalid_argument("Empirical Distribution: Line " +
+				std::to_string(lineno) + " of \"" + filename + "\" has the " \
+				"wrong number of values.");
+
+		try
+		{
+			first.push_back(cast_string<double>(tokens.front()));
+			tokens.pop();
+			if(ncolumns == 2)
+				second.push_back(cast_string<double>(tokens.front()));
+		}
+		catch(const std::bad_cast &e)
+		{
+			throw std::invalid_argument("Empirical Distribution: Unable to " \
+				"convert line " + std::to_string(lineno) + " of \"" + filename +
+				"\" to numbers.");
+		}
+	}
+
+	if(ncolumns == 2)
+		setHistogram(first, second);
+	else
+		setSamples(std::move(first));
+}
+
+void EmpiricalDistribution::setHistogram(const std::vector<double> &centers,
+	const std::vector<double> &weights)
+{
+	const std::size_t n{ centers.size() };
+
+	if(n < 2 || weights.size() != n)
+		throw std::invalid_argument("Empirical Distribution: A histogram " \
+			"needs at least 2 bins, each with a center and a weight.");
+
+	for(std::size_t j = 1; j < n; ++j)
+	{
+		if(!(centers[j] > centers[j - 1]))
+			throw std::invalid_argument("Empirical Distribution: The bin " \
+				"centers must be increasing.");
+	}
+
+	// the edges are the midpoints between the centers
+	std::vector<double> edges(n + 1);
+	edges[0] = centers[0] - 0.5 * (centers[1] - centers[0]);
+	for(std::size_t j = 1; j < n; ++j)
+		edges[j] = 0.5 * (centers[j - 1] + centers[j]);
+	edges[n] = centers[n - 1] + 0.5 * (centers[n - 1] - centers[n - 2]);
+
+	try
+	{
+		table = AliasTable(weights);
+	}
+	catch(const std::invalid_argument &e)
+	{
+		throw std::invalid_argument(std::string("Empirical Distribution: ") +
+			e.what());
+	}
+
+	left.resize(n);
+	width.resize(n);
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		left[j] = edges[j];
+		width[j] = edges[j + 1] - edges[j];
+	}
+}
+
+void EmpiricalDistribution::setSamples(std::vector<double> samples)
+{
+	std::sort(samples.begin(), samples.end());
+
+	if(samples.size() < 2 || !(samples.front() < samples.back()))
+		throw std::invalid_argument("Empirical Distribution: The samples must " \
+			"have a range.");
+
+	// each interval between consecutive samples has the same weight
+	const std::size_t n{ samples.size() - 1 };
+	table = AliasTable(std::vector<double>(n, 1.));
+
+	left.resize(n);
+	width.resize(n);
+	for(std::size_t j = 0; j < n; ++j)
+	{
+		left[j] = samples[j];
+		width[j] = samples[j + 1] - samples[j];
+	}
+}
+
+double EmpiricalDistribution::sample(Engine &engine) const
+{
+	double u, within;
+	uniformN(engine, &u, 1);
+
+	const std::size_t bin{ table.sample(u, within) };
+	return left[bin] + within * width[bin];
+}
+
+void EmpiricalDistribution::sampleN(Engine &engine, double *out,
+	std::size_t n) const
+{
+	uniformN(engine, out, n);
+
+	for(std::size_t k = 0; k < n; ++k)
+	{
+		double within;
+		const std::size_t bin{ table.sample(out[k], within) };
+		out[k] = left[bin] + within * width[bin];
+	}
+}
+
+std::string EmpiricalDistribution::info() const
+{
+	return "Empirical: " + std::to_string(table.size()) + " bins from " +
+		source + ".";
+}
+
+} // namespace molstat
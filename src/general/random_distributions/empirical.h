@@ -0,0 +1,123 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file empirical.h
+ * \brief Interface for an empirical (tabulated) distribution.
+ */
+
+#ifndef __empirical_h__
+#define __empirical_h__
+
+#include <string>
+#include <vector>
+#include "rng.h"
+#include "alias_table.h"
+
+namespace molstat {
+
+/**
+ * \brief Empirical distribution, from a histogram or from a set of samples.
+ *
+ * The distribution is a set of bins; the density is constant within each
+ * bin (the cumulative distribution function is linearly interpolated). A
+ * bin is chosen with Walker's alias method (see molstat::AliasTable), and
+ * the position within the bin uses the remaining bits of the same uniform
+ * random number, so each sample takes O(1) operations and one random number.
+ *
+ * - A histogram is given by the center and weight (e.g., the number of
+ *   counts) of each bin, as in the text output of `molstat-simulator`. The
+ *   bin edges are the midpoints between consecutive centers; the first and
+ *   last bins are symmetric about their centers.
+ * - A set of samples is sorted, and each interval between consecutive
+ *   samples is a bin with the same weight.
+ */
+class EmpiricalDistribution : public RandomDistribution
+{
+protected:
+	/// The left edge of each bin.
+	std::vector<double> left;
+
+	/// The width of each bin.
+	std::vector<double> width;
+
+	/// The table for choosing a bin.
+	AliasTable table;
+
+	/// Description of the source of the data.
+	std::string source;
+
+	/**
+	 * \brief Sets up the bins from a histogram.
+	 *
+	 * \throw std::invalid_argument if there are fewer than 2 bins, the centers
+	 *    are not increasing, or the weights are invalid.
+	 *
+	 * \param[in] centers The center of each bin.
+	 * \param[in] weights The weight of each bin.
+	 */
+	void setHistogram(const std::vector<double> &centers,
+		const std::vector<double> &weights);
+
+	/**
+	 * \brief Sets up the bins from a set of samples.
+	 *
+	 * \throw std::invalid_argument if the samples do not have a range.
+	 *
+	 * \param[in] samples The samples.
+	 */
+	void setSamples(std::vector<double> samples);
+
+public:
+	EmpiricalDistribution() = delete;
+	~EmpiricalDistribution() = default;
+
+	/**
+	 * \brief Constructor specifying a histogram.
+	 *
+	 * \throw std::invalid_argument if there are fewer than 2 bins, the centers
+	 *    are not increasing, or the weights are invalid (negative or all
+	 *    zero).
+	 *
+	 * \param[in] centers The center of each bin.
+	 * \param[in] weights The weight of each bin.
+	 */
+	EmpiricalDistribution(const std::vector<double> &centers,
+		const std::vector<double> &weights);
+
+	/**
+	 * \brief Constructor specifying a set of samples.
+	 *
+	 * \throw std::invalid_argument if the samples do not have a range.
+	 *
+	 * \param[in] samples The samples.
+	 */
+	explicit EmpiricalDistribution(const std::vector<double> &samples);
+
+	/**
+	 * \brief Constructor reading a histogram or samples from a file.
+	 *
+	 * Each (non-empty) line of the file has either two numbers (the center
+	 * and weight of a bin) or one number (a sample); all lines must have the
+	 * same number. Lines beginning with `#` are ignored.
+	 *
+	 * \throw std::invalid_argument if the file cannot be read or does not
+	 *    describe a valid distribution.
+	 *
+	 * \param[in] filename The name of the file.
+	 */
+	explicit EmpiricalDistribution(const std::string &filename);
+
+	virtual double sample(Engine &engine) const override;
+
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual std::string info() const override;
+};
+
+} // namespace molstat
+
+#endif
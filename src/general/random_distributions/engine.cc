@@ -0,0 +1,491 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file engine.cc
+ * \brief Implementation of the random number engine.
+ */
+
+#include "engine.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace molstat {
+
+constexpr std::uint64_t Engine::default_seed;
+constexpr std::size_t Engine::blocks_per_refill;
+constexpr std::size_t Engine::buffer_size;
+
+/// The multiplier of the PCG64 linear congruential generator (high word).
+constexpr std::uint64_t pcg_mult_hi = 0x2360ED051FC65DA4ull;
+
+/// The multiplier of the PCG64 linear congruential generator (low word).
+constexpr std::uint64_t pcg_mult_lo = 0x4385DF649FCCF645ull;
+
+/**
+ * \brief The high word of the 128-bit product of two 64-bit numbers.
+ *
+ * \param[in] a The first number.
+ * \param[in] b The second number.
+ * \return The high word of a * b.
+ */
+static inline std::uint64_t mulhi64(const std::uint64_t a,
+	const std::uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+	__extension__ typedef unsigned __int128 uint128;
+	return static_cast<std::uint64_t>((static_cast<uint128>(a) * b) >> 64);
+#else
+	const std::uint64_t a0{ a & 0xFFFFFFFF }, a1{ a >> 32 };
+	const std::uint64_t b0{ b & 0xFFFFFFFF }, b1{ b >> 32 };
+	const std::uint64_t p00{ a0 * b0 }, p01{ a0 * b1 }, p10{ a1 * b0 };
+	const std::uint64_t mid{ (p00 >> 32) + (p01 & 0xFFFFFFFF) +
+		(p10 & 0xFFFFFFFF) };
+	return a1 * b1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+}
+
+/**
+ * \brief Multiplies two 128-bit numbers (modulo 2^128).
+ *
+ * \param[in,out] hi The high word of the first number; of the product on
+ *    return.
+ * \param[in,out] lo The low word of the first number; of the product on
+ *    return.
+ * \param[in] bhi The high word of the second number.
+ * \param[in] blo The low word of the second number.
+ */
+static inline void mul128(std::uint64_t &hi, std::uint64_t &lo,
+	const std::uint64_t bhi, const std::uint64_t blo)
+{
+	hi = mulhi64(lo, blo) + hi * blo + lo * bhi;
+	lo = lo * blo;
+}
+
+/**
+ * \brief Adds two 128-bit numbers (modulo 2^128).
+ *
+ * \param[in,out] hi The high word of the first number; of the sum on
+ *    return.
+ * \param[in,out] lo The low word of the first number; of the sum on return.
+ * \param[in] bhi The high word of the second number.
+ * \param[in] blo The low word of the second number.
+ */
+static inline void add128(std::uint64_t &hi, std::uint64_t &lo,
+	const std::uint64_t bhi, const std::uint64_t blo)
+{
+	lo += blo;
+	hi += bhi + (lo < blo ? 1 : 0);
+}
+
+/**
+ * \brief Rotates a 64-bit number left.
+ *
+ * \param[in] x The number.
+ * \param[in] k The number of bits, in [1, 63].
+ * \return The rotated number.
+ */
+static inline std::uint64_t rotl64(const std::uint64_t x, const int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * \brief The SplitMix64 generator, used for seeding xoshiro256++.
+ *
+ * \param[in,out] x The state of the generator.
+ * \return The next random number.
+ */
+static inline std::uint64_t splitmix64(std::uint64_t &x)
+{
+	std::uint64_t z{ x += 0x9E3779B97F4A7C15ull };
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+EngineType engineTypeFromName(const std::string &name)
+{
+	if(name == "philox")
+		return EngineType::Philox;
+	else if(name == "mt19937_64")
+		return EngineType::MT19937_64;
+	else if(name == "xoshiro256++")
+		return EngineType::Xoshiro256pp;
+	else if(name == "pcg64")
+		return EngineType::PCG64;
+
+	throw std::invalid_argument("Unknown random number engine \"" + name +
+		"\". Options are philox, mt19937_64, xoshiro256++, and pcg64.");
+}
+
+std::string engineName(EngineType type)
+{
+	switch(type)
+	{
+	case EngineType::MT19937_64:
+		return "mt19937_64";
+	case EngineType::Xoshiro256pp:
+		return "xoshiro256++";
+	case EngineType::PCG64:
+		return "pcg64";
+	default:
+		return "philox";
+	}
+}
+
+Engine::Engine(std::uint64_t seed_, std::uint64_t stream_)
+	: Engine(EngineType::Philox, seed_, stream_)
+{
+}
+
+Engine::Engine(EngineType type_, std::uint64_t seed_, std::uint64_t stream_)
+	: type(type_), key(), stream(0), block(0), mt(), state(), origin(),
+	buffer(), pos(buffer_size)
+{
+	seed(seed_);
+	substream(stream_);
+}
+
+void Engine::seed(std::uint64_t seed_)
+{
+	key[0] = static_cast<std::uint32_t>(seed_);
+	key[1] = static_cast<std::uint32_t>(seed_ >> 32);
+
+	if(type == EngineType::Xoshiro256pp)
+	{
+		// the beginning of substream 0
+		std::uint64_t x{ seed_ };
+		for(std::uint64_t &word : origin)
+			word = splitmix64(x);
+	}
+
+	stream = 0;
+	substream(0);
+}
+
+void Engine::substream(std::uint64_t stream_)
+{
+	block = 0;
+	pos = buffer_size; // empty the buffer
+
+	const std::uint64_t seedval{ (static_cast<std::uint64_t>(key[1]) << 32) |
+		key[0] };
+
+	switch(type)
+	{
+	case EngineType::MT19937_64:
+	{
+		std::seed_seq seq{ key[0], key[1],
+			static_cast<std::uint32_t>(stream_),
+			static_cast<std::uint32_t>(stream_ >> 32) };
+		mt.seed(seq);
+		break;
+	}
+
+	case EngineType::Xoshiro256pp:
+	{
+		// jump forward from the beginning of the current substream, or from
+		// the beginning of substream 0 for an earlier substream
+		if(stream_ < stream)
+		{
+			std::uint64_t x{ seedval };
+			for(std::uint64_t &word : origin)
+				word = splitmix64(x);
+			stream = 0;
+		}
+
+		for(; stream < stream_; ++stream)
+			xoshiroJump(origin);
+
+		state = origin;
+		break;
+	}
+
+	case EngineType::PCG64:
+	{
+		// pcg64_srandom_r with the seed as the initial state and the substream
+		// as the sequence
+		state[2] = stream_ >> 63;
+		state[3] = (stream_ << 1) | 1;
+		state[0] = 0;
+		state[1] = 0;
+		advance_pcg(1);
+		add128(state[0], state[1], 0, seedval);
+		advance_pcg(1);
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	stream = stream_;
+}
+
+void Engine::jump()
+{
+	substream(stream + 1);
+}
+
+/**
+ * \brief Applies a jump polynomial to a xoshiro256 state.
+ *
+ * \param[in,out] s The state.
+ * \param[in] poly The coefficients of the polynomial.
+ */
+static void xoshiro_polynomial(std::array<std::uint64_t, 4> &s,
+	const std::array<std::uint64_t, 4> &poly)
+{
+	std::array<std::uint64_t, 4> acc{{ 0, 0, 0, 0 }};
+
+	for(std::uint64_t word : poly)
+	{
+		for(int b = 0; b < 64; ++b)
+		{
+			if(word & (std::uint64_t{ 1 } << b))
+			{
+				for(std::size_t j = 0; j < 4; ++j)
+					acc[j] ^= s[j];
+			}
+
+			// one step of the linear engine
+			const std::uint64_t t{ s[1] << 17 };
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = rotl64(s[3], 45);
+		}
+	}
+
+	s = acc;
+}
+
+void Engine::xoshiroJump(std::array<std::uint64_t, 4> &s)
+{
+	// x^(2^128) modulo the characteristic polynomial (Blackman and Vigna)
+	xoshiro_polynomial(s, {{ 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+		0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull }});
+}
+
+void Engine::xoshiroLongJump(std::array<std::uint64_t, 4> &s)
+{
+	// x^(2^192) modulo the characteristic polynomial
+	xoshiro_polynomial(s, {{ 0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull,
+		0x77710069854EE241ull, 0x39109BB02ACBE635ull }});
+}
+
+void Engine::discard(unsigned long long z)
+{
+	if(type == EngineType::Philox)
+	{
+		// index (within the substream) of the next random number
+		const std::uint64_t next = block * 2 - (buffer_size - pos) + z;
+
+		// move to the set of blocks containing the new position
+		block = (next / buffer_size) * blocks_per_refill;
+		refill();
+		pos = next % buffer_size;
+		return;
+	}
+
+	// use the numbers left in the buffer
+	const std::size_t remaining{ buffer_size - pos };
+	if(z < remaining)
+	{
+		pos += z;
+		return;
+	}
+	z -= remaining;
+	pos = buffer_size;
+
+	if(type == EngineType::PCG64)
+		advance_pcg(z);
+	else
+	{
+		for(; z >= buffer_size; z -= buffer_size)
+			refill();
+
+		refill();
+		pos = z;
+	}
+}
+
+void Engine::generate(result_type *out, std::size_t n)
+{
+	while(n > 0)
+	{
+		if(pos == buffer_size)
+		{
+			// skip the buffer when a whole buffer is requested
+			if(n >= buffer_size)
+			{
+				fill(out);
+				out += buffer_size;
+				n -= buffer_size;
+				continue;
+			}
+
+			refill();
+		}
+
+		const std::size_t m{ std::min(n, buffer_size - pos) };
+		std::copy(buffer.begin() + pos, buffer.begin() + pos + m, out);
+
+		pos += m;
+		out += m;
+		n -= m;
+	}
+}
+
+void Engine::refill()
+{
+	fill(buffer.data());
+	pos = 0;
+}
+
+void Engine::fill(result_type *out)
+{
+	switch(type)
+	{
+	case EngineType::MT19937_64:
+		fill_mt(out);
+		break;
+	case EngineType::Xoshiro256pp:
+		fill_xoshiro(out);
+		break;
+	case EngineType::PCG64:
+		fill_pcg(out);
+		break;
+	default:
+		fill_philox(out);
+		break;
+	}
+}
+
+void Engine::fill_philox(result_type *out)
+{
+	for(std::size_t j = 0; j < blocks_per_refill; ++j, ++block)
+	{
+		const std::array<std::uint32_t, 4> r = philox({{
+			static_cast<std::uint32_t>(block),
+			static_cast<std::uint32_t>(block >> 32),
+			static_cast<std::uint32_t>(stream),
+			static_cast<std::uint32_t>(stream >> 32) }}, key);
+
+		out[2*j] = (static_cast<result_type>(r[1]) << 32) | r[0];
+		out[2*j + 1] = (static_cast<result_type>(r[3]) << 32) | r[2];
+	}
+}
+
+void Engine::fill_mt(result_type *out)
+{
+	for(std::size_t j = 0; j < buffer_size; ++j)
+		out[j] = mt();
+}
+
+void Engine::fill_xoshiro(result_type *out)
+{
+	std::uint64_t s0{ state[0] }, s1{ state[1] }, s2{ state[2] },
+		s3{ state[3] };
+
+	for(std::size_t j = 0; j < buffer_size; ++j)
+	{
+		out[j] = rotl64(s0 + s3, 23) + s0;
+
+		const std::uint64_t t{ s1 << 17 };
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = rotl64(s3, 45);
+	}
+
+	state = {{ s0, s1, s2, s3 }};
+}
+
+void Engine::fill_pcg(result_type *out)
+{
+	std::uint64_t hi{ state[0] }, lo{ state[1] };
+
+	for(std::size_t j = 0; j < buffer_size; ++j)
+	{
+		// advance the LCG, then output with the XSL-RR permutation
+		mul128(hi, lo, pcg_mult_hi, pcg_mult_lo);
+		add128(hi, lo, state[2], state[3]);
+
+		const std::uint64_t x{ hi ^ lo };
+		const int rot{ static_cast<int>(hi >> 58) };
+		out[j] = rot == 0 ? x : (x >> rot) | (x << (64 - rot));
+	}
+
+	state[0] = hi;
+	state[1] = lo;
+}
+
+void Engine::advance_pcg(unsigned long long z)
+{
+	// Brown, "Random number generation with arbitrary strides" (1994):
+	// z steps of s -> m*s + c is s -> M*s + C, built by repeated squaring
+	std::uint64_t acc_mult_hi{ 0 }, acc_mult_lo{ 1 };
+	std::uint64_t acc_plus_hi{ 0 }, acc_plus_lo{ 0 };
+	std::uint64_t cur_mult_hi{ pcg_mult_hi }, cur_mult_lo{ pcg_mult_lo };
+	std::uint64_t cur_plus_hi{ state[2] }, cur_plus_lo{ state[3] };
+
+	for(; z > 0; z >>= 1)
+	{
+		if(z & 1)
+		{
+			mul128(acc_mult_hi, acc_mult_lo, cur_mult_hi, cur_mult_lo);
+			mul128(acc_plus_hi, acc_plus_lo, cur_mult_hi, cur_mult_lo);
+			add128(acc_plus_hi, acc_plus_lo, cur_plus_hi, cur_plus_lo);
+		}
+
+		// cur_plus = (cur_mult + 1) * cur_plus; cur_mult = cur_mult^2
+		std::uint64_t hi{ cur_mult_hi }, lo{ cur_mult_lo };
+		add128(hi, lo, 0, 1);
+		mul128(cur_plus_hi, cur_plus_lo, hi, lo);
+		mul128(cur_mult_hi, cur_mult_lo, cur_mult_hi, cur_mult_lo);
+	}
+
+	mul128(state[0], state[1], acc_mult_hi, acc_mult_lo);
+	add128(state[0], state[1], acc_plus_hi, acc_plus_lo);
+}
+
+std::array<std::uint32_t, 4> Engine::philox(std::array<std::uint32_t, 4> ctr,
+	std::array<std::uint32_t, 2> k)
+{
+	// constants from Salmon et al.
+	constexpr std::uint64_t m0 = 0xD2511F53;
+	constexpr std::uint64_t m1 = 0xCD9E8D57;
+	constexpr std::uint32_t w0 = 0x9E3779B9;
+	constexpr std::uint32_t w1 = 0xBB67AE85;
+
+	for(int round = 0; round < 10; ++round)
+	{
+		if(round > 0)
+		{
+			// bump the key
+			k[0] += w0;
+			k[1] += w1;
+		}
+
+		const std::uint64_t p0 = m0 * ctr[0];
+		const std::uint64_t p1 = m1 * ctr[2];
+
+		ctr = {{
+			static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ k[0],
+			static_cast<std::uint32_t>(p1),
+			static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ k[1],
+			static_cast<std::uint32_t>(p0) }};
+	}
+
+	return ctr;
+}
+
+} // namespace molstat
@@ -0,0 +1,319 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file engine.h
+ * \brief Random number engine with reproducible, parallel random number
+ *    streams and a choice of generators.
+ */
+
+#ifndef __engine_h__
+#define __engine_h__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace molstat {
+
+/// The random number generators available to molstat::Engine.
+enum class EngineType
+{
+	/// The counter-based Philox4x32-10 generator; the default.
+	Philox,
+
+	/// The 64-bit Mersenne twister (`std::mt19937_64`).
+	MT19937_64,
+
+	/// The xoshiro256++ generator (Blackman and Vigna, 2019).
+	Xoshiro256pp,
+
+	/// The PCG64 (XSL-RR 128/64) generator (O'Neill, 2014).
+	PCG64
+};
+
+/**
+ * \brief Gets the generator with the specified name.
+ *
+ * The names are `philox`, `mt19937_64`, `xoshiro256++`, and `pcg64`.
+ *
+ * \throw std::invalid_argument if the name is not recognized.
+ *
+ * \param[in] name The name (lowercase).
+ * \return The generator.
+ */
+EngineType engineTypeFromName(const std::string &name);
+
+/**
+ * \brief Gets the name of a generator.
+ *
+ * \param[in] type The generator.
+ * \return The name, as accepted by engineTypeFromName.
+ */
+std::string engineName(EngineType type);
+
+/**
+ * \brief Random number engine with independent substreams.
+ *
+ * By default, the engine uses the counter-based Philox4x32-10 generator.
+ *
+ * Philox (Salmon et al., "Parallel random numbers: As easy as 1, 2, 3",
+ * SC11) is a keyed bijection of a 128-bit counter. The random number stream
+ * is therefore determined entirely by the key (the seed) and the counter,
+ * and any position in the stream can be reached in O(1) operations.
+ *
+ * The 128-bit counter is split into a 64-bit substream index and a 64-bit
+ * position within the substream. Each substream is an independent stream of
+ * \f$2^{64}\f$ blocks; the simulator assigns a fixed block of trials to each
+ * substream so that the results do not depend on how the blocks are
+ * distributed among threads.
+ *
+ * The other generators (see molstat::EngineType) are selected when the
+ * engine is constructed. Their substreams are formed from the seed and the
+ * substream index:
+ * - `mt19937_64` is seeded with a `std::seed_seq` of both.
+ * - `xoshiro256++` is seeded with SplitMix64 from the seed, and substream
+ *   `s` begins `s` jumps (of \f$2^{128}\f$ numbers each) later.
+ * - `pcg64` uses the seed as its initial state and the substream to choose
+ *   its increment (PCG's own streams).
+ *
+ * The random numbers are produced into a buffer of 256 numbers. The
+ * generator is chosen once per refill of the buffer (not once per random
+ * number), and each refill runs the selected generator in a tight loop;
+ * generate() fills whole buffers directly into its output.
+ *
+ * The engine satisfies the requirements of a C++11 uniform random number
+ * generator, and can be used with the C++11 distributions.
+ */
+class Engine
+{
+public:
+	/// The type of random number produced.
+	using result_type = std::uint_fast64_t;
+
+	/// The seed used by the default constructor.
+	static constexpr std::uint64_t default_seed = 0xFEEDFACE;
+
+private:
+	/// The generator.
+	EngineType type;
+
+	/// Number of Philox blocks computed at a time.
+	static constexpr std::size_t blocks_per_refill = 128;
+
+	/// Number of 64-bit results computed at a time (2 per block).
+	static constexpr std::size_t buffer_size = 2 * blocks_per_refill;
+
+	/// The key (seed) of the Philox generator; also the seed of the others.
+	std::array<std::uint32_t, 2> key;
+
+	/// The substream.
+	std::uint64_t stream;
+
+	/// The next block (within the substream) to be computed by Philox.
+	std::uint64_t block;
+
+	/// The state of the Mersenne twister.
+	std::mt19937_64 mt;
+
+	/**
+	 * \brief The state of the xoshiro256++ generator, or of the PCG64
+	 *    generator (state high and low words, increment high and low words).
+	 */
+	std::array<std::uint64_t, 4> state;
+
+	/// The state of the xoshiro256++ generator at the start of the substream.
+	std::array<std::uint64_t, 4> origin;
+
+	/// Buffer of random numbers.
+	std::array<result_type, buffer_size> buffer;
+
+	/// The next position in the buffer to use.
+	std::size_t pos;
+
+	/// Computes the next set of random numbers in the substream.
+	void refill();
+
+	/**
+	 * \brief Computes the next `buffer_size` random numbers in the
+	 *    substream with the selected generator.
+	 *
+	 * \param[out] out Storage for the random numbers.
+	 */
+	void fill(result_type *out);
+
+	/**
+	 * \brief Computes the next set of Philox blocks in the substream.
+	 *
+	 * \param[out] out Storage for the `buffer_size` random numbers.
+	 */
+	void fill_philox(result_type *out);
+
+	/**
+	 * \brief Computes the next set of random numbers with the Mersenne
+	 *    twister.
+	 *
+	 * \param[out] out Storage for the `buffer_size` random numbers.
+	 */
+	void fill_mt(result_type *out);
+
+	/**
+	 * \brief Computes the next set of random numbers with xoshiro256++.
+	 *
+	 * \param[out] out Storage for the `buffer_size` random numbers.
+	 */
+	void fill_xoshiro(result_type *out);
+
+	/**
+	 * \brief Computes the next set of random numbers with PCG64.
+	 *
+	 * \param[out] out Storage for the `buffer_size` random numbers.
+	 */
+	void fill_pcg(result_type *out);
+
+	/**
+	 * \brief Advances the PCG64 generator in O(log z) operations.
+	 *
+	 * \param[in] z The number of steps.
+	 */
+	void advance_pcg(unsigned long long z);
+
+public:
+	/**
+	 * \brief Constructor specifying the seed and substream, using the
+	 *    Philox generator.
+	 *
+	 * \param[in] seed_ The seed.
+	 * \param[in] stream_ The substream.
+	 */
+	explicit Engine(std::uint64_t seed_ = default_seed,
+		std::uint64_t stream_ = 0);
+
+	/**
+	 * \brief Constructor specifying the generator, seed, and substream.
+	 *
+	 * \param[in] type_ The generator.
+	 * \param[in] seed_ The seed.
+	 * \param[in] stream_ The substream.
+	 */
+	Engine(EngineType type_, std::uint64_t seed_, std::uint64_t stream_ = 0);
+
+	/**
+	 * \brief Gets the generator used by this engine.
+	 *
+	 * \return The generator.
+	 */
+	EngineType getType() const noexcept
+	{
+		return type;
+	}
+
+	/**
+	 * \brief Resets the seed, moving to the beginning of substream 0.
+	 *
+	 * \param[in] seed_ The seed.
+	 */
+	void seed(std::uint64_t seed_ = default_seed);
+
+	/**
+	 * \brief Moves to the beginning of the specified substream.
+	 *
+	 * With xoshiro256++, the substreams are reached by jumping. Moving to a
+	 * later substream takes one jump per substream skipped; moving to an
+	 * earlier substream starts again from substream 0.
+	 *
+	 * \param[in] stream_ The substream.
+	 */
+	void substream(std::uint64_t stream_);
+
+	/**
+	 * \brief Moves to the beginning of the next substream.
+	 *
+	 * With xoshiro256++, this is one jump of \f$2^{128}\f$ numbers from the
+	 * beginning of the current substream.
+	 */
+	void jump();
+
+	/**
+	 * \brief Advances a xoshiro256++ (or xoshiro256**) state by
+	 *    \f$2^{128}\f$ steps.
+	 *
+	 * \param[in,out] s The state.
+	 */
+	static void xoshiroJump(std::array<std::uint64_t, 4> &s);
+
+	/**
+	 * \brief Advances a xoshiro256++ (or xoshiro256**) state by
+	 *    \f$2^{192}\f$ steps.
+	 *
+	 * \param[in,out] s The state.
+	 */
+	static void xoshiroLongJump(std::array<std::uint64_t, 4> &s);
+
+	/**
+	 * \brief Advances the engine's state by the specified number of random
+	 *    numbers (within the current substream).
+	 *
+	 * This takes O(1) operations with Philox and O(log z) operations with
+	 * PCG64; the other generators draw and discard the numbers.
+	 *
+	 * \param[in] z The number of random numbers to skip.
+	 */
+	void discard(unsigned long long z);
+
+	/**
+	 * \brief Produces a random number.
+	 *
+	 * \return The random number.
+	 */
+	result_type operator()()
+	{
+		if(pos == buffer_size)
+			refill();
+
+		return buffer[pos++];
+	}
+
+	/**
+	 * \brief Produces several random numbers.
+	 *
+	 * The numbers are the same as those from `n` calls to operator()(), but
+	 * are copied from the generator's buffer in blocks; whole buffers are
+	 * computed directly in `out`.
+	 *
+	 * \param[out] out Storage for the random numbers.
+	 * \param[in] n The number of random numbers.
+	 */
+	void generate(result_type *out, std::size_t n);
+
+	/// \cond
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<std::uint64_t>::max();
+	}
+	/// \endcond
+
+	/**
+	 * \brief The Philox4x32-10 bijection.
+	 *
+	 * \param[in] ctr The 128-bit counter.
+	 * \param[in] k The 64-bit key.
+	 * \return The 128 random bits for the counter.
+	 */
+	static std::array<std::uint32_t, 4> philox(
+		std::array<std::uint32_t, 4> ctr, std::array<std::uint32_t, 2> k);
+};
+
+} // namespace molstat
+
+#endif
@@ -12,6 +12,9 @@
  */
 
 #include "gamma.h"
+#include "ziggurat.h"
+#include <algorithm>
+#include <cmath>
 
 namespace molstat {
 
@@ -25,7 +28,60 @@ GammaDistribution::GammaDistribution(const double shape, const double scale)
 
 double GammaDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	// draw from a local copy; the C++11 distributions may cache state
+	std::gamma_distribution<double> local{ dist.param() };
+	return local(engine);
+}
+
+void GammaDistribution::sampleN(Engine &engine, double *out,
+	std::size_t n) const
+{
+	// Marsaglia and Tsang's method (ACM Trans. Math. Softw. 26, 363 (2000))
+	// for shape >= 1; smaller shapes use gamma(shape + 1) * u^(1/shape)
+	const double shape{ dist.alpha() };
+	const double scale{ dist.beta() };
+	const bool boost{ shape < 1. };
+	const double d{ (boost ? shape + 1. : shape) - 1. / 3. };
+	const double c{ 1. / std::sqrt(9. * d) };
+
+	// the candidates are drawn in blocks of (at most) the number of samples
+	// still needed; nearly all are accepted
+	double z[sample_block], u[sample_block];
+	std::size_t next{ 0 }, avail{ 0 };
+
+	for(std::size_t k = 0; k < n;)
+	{
+		if(next == avail)
+		{
+			avail = std::min(sample_block, n - k);
+			zigguratNormalN(engine, z, avail);
+			uniformN(engine, u, avail);
+			next = 0;
+		}
+
+		const double t{ 1. + c * z[next] };
+		const double v{ t * t * t };
+		if(v > 0. && std::log(1. - u[next]) <
+			0.5 * z[next] * z[next] + d - d * v + d * std::log(v))
+		{
+			out[k++] = d * v;
+		}
+		++next;
+	}
+
+	if(boost)
+	{
+		for(std::size_t start = 0; start < n; start += sample_block)
+		{
+			const std::size_t m{ std::min(sample_block, n - start) };
+			uniformN(engine, u, m);
+			for(std::size_t k = 0; k < m; ++k)
+				out[start + k] *= std::pow(1. - u[k], 1. / shape);
+		}
+	}
+
+	for(std::size_t k = 0; k < n; ++k)
+		out[k] *= scale;
 }
 
 std::string GammaDistribution::info() const
@@ -26,8 +26,13 @@ namespace molstat {
 class GammaDistribution : public RandomDistribution
 {
 protected:
-	/// The C++11 gamma distribution
-	mutable std::gamma_distribution<double> dist;
+	/**
+	 * \brief The C++11 gamma distribution.
+	 *
+	 * Only the parameters of this object are used; sample() draws from a
+	 * local copy so that the distribution can be shared between threads.
+	 */
+	const std::gamma_distribution<double> dist;
 
 public:
 	GammaDistribution() = delete;
@@ -46,6 +51,9 @@ public:
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const
+		override;
+
 	virtual std::string info() const override;
 };
 
@@ -12,12 +12,14 @@
  */
 
 #include "lognormal.h"
+#include "ziggurat.h"
+#include <cmath>
 
 namespace molstat {
 
 LognormalDistribution::LognormalDistribution(const double zeta,
-	const double sigma)
-	: RandomDistribution(), dist(zeta, sigma)
+	const double sigma, const NormalMethod method_)
+	: RandomDistribution(), dist(zeta, sigma), method(method_)
 {
 	if(sigma <= 0.)
 		throw std::invalid_argument("Lognormal Distribution: The standard " \
@@ -26,13 +28,35 @@ LognormalDistribution::LognormalDistribution(const double zeta,
 
 double LognormalDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	if(method == NormalMethod::Ziggurat)
+		return std::exp(dist.m() + dist.s() * zigguratNormal(engine));
+
+	// the same transform as sampleN, so that both give the same numbers
+	double z;
+	NormalDistribution::standardN(engine, &z, 1);
+	return std::exp(dist.m() + dist.s() * z);
+}
+
+void LognormalDistribution::sampleN(Engine &engine, double *out,
+	std::size_t n) const
+{
+	const double zeta{ dist.m() };
+	const double sigma{ dist.s() };
+
+	if(method == NormalMethod::Ziggurat)
+		zigguratNormalN(engine, out, n);
+	else
+		NormalDistribution::standardN(engine, out, n);
+
+	for(std::size_t k = 0; k < n; ++k)
+		out[k] = std::exp(zeta + sigma * out[k]);
 }
 
 std::string LognormalDistribution::info() const
 {
 	return "Lognormal: mean = " + std::to_string(dist.m()) +
-		" and stdev = " + std::to_string(dist.s()) + " (log space).";
+		" and stdev = " + std::to_string(dist.s()) + " (log space)" +
+		(method == NormalMethod::BoxMuller ? ", Box-Muller." : ".");
 }
 
 } // namespace molstat
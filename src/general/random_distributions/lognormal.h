@@ -19,6 +19,7 @@
 #include <string>
 #include <random>
 #include "rng.h"
+#include "normal.h"
 
 namespace molstat {
 
@@ -26,8 +27,16 @@ namespace molstat {
 class LognormalDistribution : public RandomDistribution
 {
 protected:
-	/// The C++11 lognormal distribution.
-	mutable std::lognormal_distribution<double> dist;
+	/**
+	 * \brief The C++11 lognormal distribution.
+	 *
+	 * Only the parameters of this object are used; sample() draws from a
+	 * local copy so that the distribution can be shared between threads.
+	 */
+	const std::lognormal_distribution<double> dist;
+
+	/// The method for generating the underlying normal random numbers.
+	const NormalMethod method;
 
 public:
 	LognormalDistribution() = delete;
@@ -40,11 +49,17 @@ public:
 	 *
 	 * \param[in] zeta The average (in log-space).
 	 * \param[in] sigma The standard deviation (in log-space).
+	 * \param[in] method_ The method for generating the underlying normal
+	 *    random numbers.
 	 */
-	LognormalDistribution(const double zeta, const double sigma);
+	LognormalDistribution(const double zeta, const double sigma,
+		const NormalMethod method_ = NormalMethod::Ziggurat);
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const
+		override;
+
 	virtual std::string info() const override;
 };
 
@@ -0,0 +1,130 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file mixture.cc
+ * \brief Implementation of the mixture of distributions.
+ */
+
+#include "mixture.h"
+#include <stdexcept>
+
+namespace molstat {
+
+MixtureDistribution::MixtureDistribution(const std::vector<double> &weights_,
+	const std::vector<std::shared_ptr<const RandomDistribution>> &components_)
+	: RandomDistribution(), weights(weights_), components(components_)
+{
+	if(components.size() == 0 || weights.size() != components.size())
+		throw std::invalid_argument("Mixture Distribution: Each component " \
+			"needs a weight.");
+
+	try
+	{
+		table = AliasTable(weights);
+	}
+	catch(const std::invalid_argument &e)
+	{
+		throw std::invalid_argument(std::string("Mixture Distribution: ") +
+			e.what());
+	}
+
+	double total{ 0. };
+	for(double w : weights)
+		total += w;
+	for(double &w : weights)
+		w /= total;
+}
+
+double MixtureDistribution::sample(Engine &engine) const
+{
+	double u, within;
+	uniformN(engine, &u, 1);
+
+	return components[table.sample(u, within)]->sample(engine);
+}
+
+/**
+ * \brief Scratch storage for MixtureDistribution::sampleN.
+ *
+ * The storage is kept between calls (one per thread), so that sampling a
+ * block does not allocate memory once the storage is large enough.
+ */
+struct MixtureScratch
+{
+	/// The uniform random numbers, and then the samples of each component.
+	std::vector<double> values;
+
+	/// The component chosen for each sample.
+	std::vector<std::size_t> choice;
+
+	/// The number of samples (and then the offset) of each component; zero
+	/// between calls.
+	std::vector<std::size_t> count;
+
+	/// The components chosen at least once, in order of first use.
+	std::vector<std::size_t> used;
+};
+
+static thread_local MixtureScratch scratch;
+
+void MixtureDistribution::sampleN(Engine &engine, double *out,
+	std::size_t n) const
+{
+	std::vector<double> &values = scratch.values;
+	std::vector<std::size_t> &choice = scratch.choice;
+	std::vector<std::size_t> &count = scratch.count;
+	std::vector<std::size_t> &used = scratch.used;
+
+	values.resize(n);
+	choice.resize(n);
+	if(count.size() < components.size())
+		count.resize(components.size(), 0);
+	used.clear();
+
+	// choose the component of each sample
+	uniformN(engine, values.data(), n);
+	for(std::size_t k = 0; k < n; ++k)
+	{
+		double within;
+		const std::size_t c{ table.sample(values[k], within) };
+		choice[k] = c;
+		if(count[c]++ == 0)
+			used.push_back(c);
+	}
+
+	// sample each component's share into its own slice; the counts become
+	// the offsets of the slices
+	std::size_t offset{ 0 };
+	for(std::size_t c : used)
+	{
+		const std::size_t m{ count[c] };
+		components[c]->sampleN(engine, values.data() + offset, m);
+		count[c] = offset;
+		offset += m;
+	}
+
+	// put the samples in place
+	for(std::size_t k = 0; k < n; ++k)
+		out[k] = values[count[choice[k]]++];
+
+	for(std::size_t c : used)
+		count[c] = 0;
+}
+
+std::string MixtureDistribution::info() const
+{
+	std::string ret{ "Mixture:" };
+
+	for(std::size_t c = 0; c < components.size(); ++c)
+	{
+		ret += "\n      weight " + std::to_string(weights[c]) + ": " +
+			components[c]->info();
+	}
+
+	return ret;
+}
+
+} // namespace molstat
@@ -0,0 +1,74 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file mixture.h
+ * \brief Interface for a mixture of distributions.
+ */
+
+#ifndef __mixture_h__
+#define __mixture_h__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "rng.h"
+#include "alias_table.h"
+
+namespace molstat {
+
+/**
+ * \brief Mixture (weighted sum) of several distributions.
+ *
+ * Each sample chooses a component with Walker's alias method (see
+ * molstat::AliasTable), in O(1) operations regardless of the number of
+ * components, and then samples from that component. sampleN() chooses the
+ * components for the whole block first, samples each chosen component's
+ * share into its own slice of scratch storage with the component's
+ * sampleN(), and then puts the samples in place in one pass; a block of n
+ * samples thus also takes O(n) operations regardless of the number of
+ * components.
+ */
+class MixtureDistribution : public RandomDistribution
+{
+protected:
+	/// The normalized weight of each component.
+	std::vector<double> weights;
+
+	/// The components.
+	std::vector<std::shared_ptr<const RandomDistribution>> components;
+
+	/// The table for choosing a component.
+	AliasTable table;
+
+public:
+	MixtureDistribution() = delete;
+	~MixtureDistribution() = default;
+
+	/**
+	 * \brief Constructor specifying the weights and components.
+	 *
+	 * \throw std::invalid_argument if there are no components, the numbers of
+	 *    weights and components differ, a weight is negative, or all of the
+	 *    weights are zero.
+	 *
+	 * \param[in] weights_ The (unnormalized) weight of each component.
+	 * \param[in] components_ The components.
+	 */
+	MixtureDistribution(const std::vector<double> &weights_,
+		const std::vector<std::shared_ptr<const RandomDistribution>>
+		&components_);
+
+	virtual double sample(Engine &engine) const override;
+
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	virtual std::string info() const override;
+};
+
+} // namespace molstat
+
+#endif
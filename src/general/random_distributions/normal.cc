@@ -12,11 +12,15 @@
  */
 
 #include "normal.h"
+#include "ziggurat.h"
+#include <algorithm>
+#include <cmath>
 
 namespace molstat {
 
-NormalDistribution::NormalDistribution(const double mean, const double stdev)
-	: RandomDistribution(), dist(mean, stdev)
+NormalDistribution::NormalDistribution(const double mean, const double stdev,
+	const NormalMethod method_)
+	: RandomDistribution(), dist(mean, stdev), method(method_)
 {
 	if(stdev <= 0.)
 		throw std::invalid_argument("Normal Distribution: The standard " \
@@ -25,13 +29,65 @@ NormalDistribution::NormalDistribution(const double mean, const double stdev)
 
 double NormalDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	if(method == NormalMethod::Ziggurat)
+		return dist.mean() + dist.stddev() * zigguratNormal(engine);
+
+	// the same transform as sampleN, so that both give the same numbers
+	double z;
+	standardN(engine, &z, 1);
+	return dist.mean() + dist.stddev() * z;
+}
+
+void NormalDistribution::sampleN(Engine &engine, double *out,
+	std::size_t n) const
+{
+	const double mean{ dist.mean() };
+	const double stdev{ dist.stddev() };
+
+	if(method == NormalMethod::Ziggurat)
+		zigguratNormalN(engine, out, n);
+	else
+		standardN(engine, out, n);
+
+	for(std::size_t k = 0; k < n; ++k)
+		out[k] = mean + stdev * out[k];
+}
+
+void NormalDistribution::standardN(Engine &engine, double *z, std::size_t n)
+{
+	constexpr double twopi{ 6.283185307179586477 };
+	double u[sample_block];
+
+	for(std::size_t start = 0; start < n; start += sample_block)
+	{
+		// each pair of uniform random numbers gives two normal random numbers;
+		// an odd count uses one extra pair
+		const std::size_t m{ std::min(sample_block, n - start) };
+		const std::size_t pairs{ (m + 1) / 2 };
+		uniformN(engine, u, 2 * pairs);
+
+		double *block{ z + start };
+		for(std::size_t k = 0; k < m / 2; ++k)
+		{
+			// 1 - u is in (0, 1], so the logarithm is finite
+			const double r{ std::sqrt(-2. * std::log(1. - u[2 * k])) };
+			const double theta{ twopi * u[2 * k + 1] };
+
+			block[2 * k] = r * std::cos(theta);
+			block[2 * k + 1] = r * std::sin(theta);
+		}
+
+		if(m % 2 == 1)
+			block[m - 1] = std::sqrt(-2. * std::log(1. - u[m - 1])) *
+				std::cos(twopi * u[m]);
+	}
 }
 
 std::string NormalDistribution::info() const
 {
 	return "Normal: mean = " + std::to_string(dist.mean()) + " and stdev = " +
-		std::to_string(dist.stddev()) + ".";
+		std::to_string(dist.stddev()) +
+		(method == NormalMethod::BoxMuller ? " (Box-Muller)." : ".");
 }
 
 } // namespace molstat
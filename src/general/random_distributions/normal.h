@@ -22,12 +22,33 @@
 
 namespace molstat {
 
+/// The methods for generating normal random numbers.
+enum class NormalMethod
+{
+	/// The ziggurat method (see zigguratNormal); the default.
+	Ziggurat,
+
+	/**
+	 * \brief The Box-Muller transform (NormalDistribution::standardN), for
+	 *    both single numbers and blocks.
+	 */
+	BoxMuller
+};
+
 /// Normal distribution.
 class NormalDistribution : public RandomDistribution
 {
 protected:
-	/// The C++11 normal distribution.
-	mutable std::normal_distribution<double> dist;
+	/**
+	 * \brief The C++11 normal distribution.
+	 *
+	 * Only the parameters of this object are used; sample() draws from a
+	 * local copy so that the distribution can be shared between threads.
+	 */
+	const std::normal_distribution<double> dist;
+
+	/// The method for generating the random numbers.
+	const NormalMethod method;
 
 public:
 	NormalDistribution() = delete;
@@ -40,11 +61,29 @@ public:
 	 *
 	 * \param[in] mean The mean.
 	 * \param[in] stdev The standard deviation.
+	 * \param[in] method_ The method for generating the random numbers.
 	 */
-	NormalDistribution(const double mean, const double stdev);
+	NormalDistribution(const double mean, const double stdev,
+		const NormalMethod method_ = NormalMethod::Ziggurat);
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const
+		override;
+
+	/**
+	 * \brief Generates standard normal random numbers (mean 0 and standard
+	 *    deviation 1).
+	 *
+	 * Blocks of uniform random numbers are transformed in pairs with the
+	 * Box-Muller transform, which has no rejection step.
+	 *
+	 * \param[in] engine The random number engine.
+	 * \param[out] z Storage for the random numbers.
+	 * \param[in] n The number of random numbers.
+	 */
+	static void standardN(Engine &engine, double *z, std::size_t n);
+
 	virtual std::string info() const override;
 };
 
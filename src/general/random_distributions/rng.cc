@@ -19,11 +19,77 @@
 #include "lognormal.h"
 #include "gamma.h"
 #include "weibull.h"
+#include "empirical.h"
+#include "mixture.h"
+#include <algorithm>
+#include <vector>
 
 using namespace std;
 
 namespace molstat {
 
+void RandomDistribution::sampleN(Engine &engine, double *out, std::size_t n)
+	const
+{
+	for(std::size_t k = 0; k < n; ++k)
+		out[k] = sample(engine);
+}
+
+void uniformN(Engine &engine, double *u, std::size_t n)
+{
+	// 2^-53
+	constexpr double scale{ 1. / 9007199254740992. };
+
+	Engine::result_type bits[sample_block];
+
+	for(std::size_t start = 0; start < n; start += sample_block)
+	{
+		const std::size_t m{ std::min(sample_block, n - start) };
+
+		engine.generate(bits, m);
+		for(std::size_t k = 0; k < m; ++k)
+			u[start + k] = static_cast<double>(bits[k] >> 11) * scale;
+	}
+}
+
+/**
+ * \brief Reads the (optional) method for generating normal random numbers.
+ *
+ * \throw std::invalid_argument if the method is not recognized.
+ *
+ * \param[in] tokens The remaining tokens; the method, if any, is the first.
+ * \return The method; the ziggurat method if none is specified.
+ */
+static NormalMethod read_normal_method(const TokenContainer &tokens)
+{
+	if(tokens.size() == 0)
+		return NormalMethod::Ziggurat;
+
+	const string method{ to_lower(tokens.front()) };
+	if(method == "ziggurat")
+		return NormalMethod::Ziggurat;
+	else if(method == "boxmuller")
+		return NormalMethod::BoxMuller;
+
+	throw invalid_argument("Unknown method \"" + tokens.front() + "\" for " \
+		"normal random numbers. Options are ziggurat and boxmuller.");
+}
+
+/**
+ * \brief Determines if a token is the name of a distribution that can be a
+ *    component of a mixture.
+ *
+ * \param[in] token The token.
+ * \return True if the token names such a distribution, false otherwise.
+ */
+static bool is_component_name(const string &token)
+{
+	static const string names[] = { "constant", "uniform", "normal",
+		"gaussian", "lognormal", "gamma", "weibull", "empirical" };
+
+	return std::find(begin(names), end(names), to_lower(token)) != end(names);
+}
+
 std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 	TokenContainer &&tokens)
 {
@@ -97,7 +163,7 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 		// distribution, respectively
 		if(tokens.size() < 2)
 			throw invalid_argument("Invalid normal distribution. Use\n" \
-				"   normal mean standard-deviation");
+				"   normal mean standard-deviation [ziggurat | boxmuller]");
 
 		double mean, stdev;
 		try
@@ -120,9 +186,10 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 			throw invalid_argument(
 				"Unable to convert \"stdev\" to a numeric value.");
 		}
+		tokens.pop();
 
 		ret = unique_ptr<RandomDistribution>(
-			new NormalDistribution(mean, stdev));
+			new NormalDistribution(mean, stdev, read_normal_method(tokens)));
 	}
 	else if(type == "lognormal")
 	{
@@ -130,7 +197,7 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 		// space), respectively
 		if(tokens.size() < 2)
 			throw invalid_argument("Invalid lognormal distribution. Use\n" \
-				"   lognormal zeta sigma");
+				"   lognormal zeta sigma [ziggurat | boxmuller]");
 
 		double zeta, sigma;
 		try
@@ -153,9 +220,10 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 			throw invalid_argument(
 				"Unable to convert \"sigma\" to a numeric value.");
 		}
+		tokens.pop();
 
 		ret = unique_ptr<RandomDistribution>(
-			new LognormalDistribution(zeta, sigma));
+			new LognormalDistribution(zeta, sigma, read_normal_method(tokens)));
 	}
 	else if(type == "gamma")
 	{
@@ -221,6 +289,74 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 		ret = unique_ptr<RandomDistribution>(
 			new WeibullDistribution(shape, scale));
 	}
+	else if(type == "empirical")
+	{
+		// tokens[0] is the file containing the histogram or samples
+		if(tokens.size() < 1)
+			throw invalid_argument("Invalid empirical distribution. Use\n" \
+				"   empirical filename");
+
+		ret = unique_ptr<RandomDistribution>(
+			new EmpiricalDistribution(tokens.front()));
+	}
+	else if(type == "mixture")
+	{
+		// the tokens are a weight followed by a distribution (with its
+		// arguments), repeated for each component. a new component starts
+		// with a number that is followed by the name of a distribution.
+		vector<string> list;
+		for(; tokens.size() > 0; tokens.pop())
+			list.push_back(tokens.front());
+
+		vector<double> weights;
+		vector<shared_ptr<const RandomDistribution>> components;
+		size_t j{ 0 };
+		while(j < list.size())
+		{
+			if(j + 1 >= list.size() || !is_component_name(list[j + 1]))
+				throw invalid_argument("Invalid mixture distribution. Use\n" \
+					"   mixture w1 distribution1 ... w2 distribution2 ...\n" \
+					"where the distributions cannot be mixtures.");
+
+			try
+			{
+				weights.push_back(cast_string<double>(list[j]));
+			}
+			catch(const bad_cast &e)
+			{
+				throw invalid_argument("Unable to convert the weight \"" +
+					list[j] + "\" to a numeric value.");
+			}
+
+			// find the start of the next component
+			size_t next{ j + 2 };
+			while(next < list.size())
+			{
+				if(next + 1 < list.size() && is_component_name(list[next + 1]))
+				{
+					try
+					{
+						cast_string<double>(list[next]);
+						break;
+					}
+					catch(const bad_cast &e)
+					{
+					}
+				}
+				++next;
+			}
+
+			TokenContainer component;
+			for(size_t k = j + 1; k < next; ++k)
+				component.push(list[k]);
+			components.emplace_back(RandomDistributionFactory(move(component)));
+
+			j = next;
+		}
+
+		ret = unique_ptr<RandomDistribution>(
+			new MixtureDistribution(weights, components));
+	}
 	else
 		throw invalid_argument(
 			string("Unrecognized probability distribution: \"") + type + "\".\n" \
@@ -231,7 +367,9 @@ std::unique_ptr<RandomDistribution> RandomDistributionFactory(
 			"   Gaussian - Normal (Gaussian) distribution.\n" \
 			"   Lognormal - Lognormal distribution.\n" \
 			"   Gamma - Gamma distribution.\n" \
-			"   Weibull - Weibull distribution.\n");
+			"   Weibull - Weibull distribution.\n" \
+			"   Empirical - Histogram or samples from a file.\n" \
+			"   Mixture - Weighted mixture of distributions.\n");
 
 	return ret;
 }
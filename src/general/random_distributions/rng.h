@@ -14,17 +14,16 @@
 #ifndef __rng_h__
 #define __rng_h__
 
+#include <cstddef>
 #include <memory>
 #include <queue>
 #include <string>
 #include <random>
 #include <general/string_tools.h>
+#include "engine.h"
 
 namespace molstat {
 
-/// The type of C++11 random number engine to use.
-using Engine = std::default_random_engine;
-
 /// Interface for random number generation.
 class RandomDistribution
 {
@@ -35,11 +34,32 @@ public:
 	/**
 	 * \brief Samples from the random number distribution.
 	 *
+	 * The simulator may share one distribution between several threads
+	 * (each with its own engine), so implementations must not modify any
+	 * state of the distribution object.
+	 *
 	 * \param[in] engine The random number engine.
 	 * \return The random number.
 	 */
 	virtual double sample(Engine &engine) const = 0;
 
+	/**
+	 * \brief Samples several random numbers from the distribution.
+	 *
+	 * The default implementation calls sample() for each number; the
+	 * distributions override it with loops that transform blocks of uniform
+	 * random numbers. The numbers need not be the same as those from `n`
+	 * calls to sample().
+	 *
+	 * As with sample(), implementations must not modify any state of the
+	 * distribution object.
+	 *
+	 * \param[in] engine The random number engine.
+	 * \param[out] out Storage for the random numbers.
+	 * \param[in] n The number of random numbers.
+	 */
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const;
+
 	/**
 	 * \brief A description of this random number distribution.
 	 *
@@ -48,6 +68,23 @@ public:
 	virtual std::string info() const = 0;
 };
 
+/**
+ * \brief The number of random numbers the distributions transform at a time
+ *    in RandomDistribution::sampleN.
+ */
+constexpr std::size_t sample_block = 256;
+
+/**
+ * \brief Generates uniform random numbers in [0, 1).
+ *
+ * Each number uses the top 53 bits of one output of the engine.
+ *
+ * \param[in] engine The random number engine.
+ * \param[out] u Storage for the random numbers.
+ * \param[in] n The number of random numbers.
+ */
+void uniformN(Engine &engine, double *u, std::size_t n);
+
 /**
  * \brief Factory for random number distributions.
  *
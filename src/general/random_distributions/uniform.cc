@@ -25,7 +25,20 @@ UniformDistribution::UniformDistribution(const double low, const double up)
 
 double UniformDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	// draw from a local copy; the C++11 distributions may cache state
+	std::uniform_real_distribution<double> local{ dist.param() };
+	return local(engine);
+}
+
+void UniformDistribution::sampleN(Engine &engine, double *out,
+	std::size_t n) const
+{
+	const double low{ dist.a() };
+	const double width{ dist.b() - dist.a() };
+
+	uniformN(engine, out, n);
+	for(std::size_t k = 0; k < n; ++k)
+		out[k] = low + width * out[k];
 }
 
 std::string UniformDistribution::info() const
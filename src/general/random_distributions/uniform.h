@@ -26,8 +26,13 @@ namespace molstat {
 class UniformDistribution : public RandomDistribution
 {
 protected:
-	/// The C++11 uniform distribution
-	mutable std::uniform_real_distribution<double> dist;
+	/**
+	 * \brief The C++11 uniform distribution.
+	 *
+	 * Only the parameters of this object are used; sample() draws from a
+	 * local copy so that the distribution can be shared between threads.
+	 */
+	const std::uniform_real_distribution<double> dist;
 	
 public:
 	UniformDistribution() = delete;
@@ -46,6 +51,9 @@ public:
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const
+		override;
+
 	virtual std::string info() const override;
 };
 
@@ -12,6 +12,8 @@
  */
 
 #include "weibull.h"
+#include "ziggurat.h"
+#include <cmath>
 
 namespace molstat {
 
@@ -28,7 +30,22 @@ WeibullDistribution::WeibullDistribution(const double shape, const double scale)
 
 double WeibullDistribution::sample(Engine &engine) const
 {
-	return dist(engine);
+	// draw from a local copy; the C++11 distributions may cache state
+	std::weibull_distribution<double> local{ dist.param() };
+	return local(engine);
+}
+
+void WeibullDistribution::sampleN(Engine &engine, double *out,
+	std::size_t n) const
+{
+	// if E is a standard exponential random number, scale * E^(1/shape) is
+	// a Weibull random number
+	const double invshape{ 1. / dist.a() };
+	const double scale{ dist.b() };
+
+	zigguratExponentialN(engine, out, n);
+	for(std::size_t k = 0; k < n; ++k)
+		out[k] = scale * std::pow(out[k], invshape);
 }
 
 std::string WeibullDistribution::info() const
@@ -26,8 +26,13 @@ namespace molstat {
 class WeibullDistribution : public RandomDistribution
 {
 protected:
-	/// The C++11 Weibull distribution.
-	mutable std::weibull_distribution<double> dist;
+	/**
+	 * \brief The C++11 Weibull distribution.
+	 *
+	 * Only the parameters of this object are used; sample() draws from a
+	 * local copy so that the distribution can be shared between threads.
+	 */
+	const std::weibull_distribution<double> dist;
 
 public:
 	WeibullDistribution() = delete;
@@ -45,6 +50,9 @@ public:
 
 	virtual double sample(Engine &engine) const override;
 
+	virtual void sampleN(Engine &engine, double *out, std::size_t n) const
+		override;
+
 	virtual std::string info() const override;
 };
 
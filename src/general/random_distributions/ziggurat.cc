@@ -0,0 +1,239 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file ziggurat.cc
+ * \brief Implementation of the ziggurat generators.
+ */
+
+#include "ziggurat.h"
+#include "rng.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace molstat {
+
+/// The number of layers in a ziggurat.
+constexpr std::size_t ziggurat_layers = 256;
+
+/// 2^-53, for converting the top 53 bits of an engine output to [0, 1).
+constexpr double ziggurat_scale = 1. / 9007199254740992.;
+
+/**
+ * \brief The layers of a ziggurat.
+ *
+ * Layer i covers [0, x[i]) between the densities f[i] and f[i+1]. Layer 0
+ * is the base: a rectangle of width x[1] (the start of the tail) together
+ * with the tail, and x[0] is the width of a rectangle with the same area.
+ */
+struct ZigguratTables
+{
+	/// The right edge of each layer; x[256] = 0.
+	std::array<double, ziggurat_layers + 1> x;
+
+	/// The density at each edge.
+	std::array<double, ziggurat_layers + 1> f;
+};
+
+/**
+ * \brief Builds the layers of a ziggurat.
+ *
+ * \param[in] r The start of the tail.
+ * \param[in] v The area of each layer.
+ * \param[in] pdf The (unnormalized, decreasing) density.
+ * \param[in] inverse The inverse of the density.
+ * \return The tables.
+ */
+static ZigguratTables make_tables(const double r, const double v,
+	double (*pdf)(double), double (*inverse)(double))
+{
+	ZigguratTables ret;
+
+	ret.x[0] = v / pdf(r);
+	ret.x[1] = r;
+	for(std::size_t i = 1; i < ziggurat_layers - 1; ++i)
+		ret.x[i + 1] = inverse(v / ret.x[i] + pdf(ret.x[i]));
+	ret.x[ziggurat_layers] = 0.;
+
+	ret.f[0] = pdf(r);
+	for(std::size_t i = 1; i <= ziggurat_layers; ++i)
+		ret.f[i] = pdf(ret.x[i]);
+
+	return ret;
+}
+
+/// The Gaussian density, without normalization.
+static double normal_pdf(double x)
+{
+	return std::exp(-0.5 * x * x);
+}
+
+/// The inverse of normal_pdf.
+static double normal_inverse(double y)
+{
+	return std::sqrt(-2. * std::log(y));
+}
+
+/// The exponential density.
+static double exponential_pdf(double x)
+{
+	return std::exp(-x);
+}
+
+/// The inverse of exponential_pdf.
+static double exponential_inverse(double y)
+{
+	return -std::log(y);
+}
+
+/// The start of the tail of the normal ziggurat.
+constexpr double normal_r = 3.6541528853610088;
+
+/// The start of the tail of the exponential ziggurat.
+constexpr double exponential_r = 7.69711747013104972;
+
+/// The layers of the normal ziggurat.
+static const ZigguratTables normal_tables{ make_tables(normal_r,
+	4.92867323399e-3, normal_pdf, normal_inverse) };
+
+/// The layers of the exponential ziggurat.
+static const ZigguratTables exponential_tables{ make_tables(exponential_r,
+	3.9496598225815571993e-3, exponential_pdf, exponential_inverse) };
+
+/**
+ * \brief Generates a uniform random number in [0, 1).
+ *
+ * \param[in] engine The random number engine.
+ * \return The random number.
+ */
+static inline double uniform(Engine &engine)
+{
+	return static_cast<double>(engine() >> 11) * ziggurat_scale;
+}
+
+/**
+ * \brief Generates a standard normal random number, starting from one output
+ *    of the engine.
+ *
+ * \param[in] engine The random number engine, for the rejected cases.
+ * \param[in] bits The first output of the engine to use.
+ * \return The random number.
+ */
+static inline double normal_from_bits(Engine &engine, std::uint64_t bits)
+{
+	const ZigguratTables &t = normal_tables;
+
+	while(true)
+	{
+		const std::size_t i{ static_cast<std::size_t>(bits & 0xff) };
+		const double sign{ (bits & 0x100) ? -1. : 1. };
+		const double x{ static_cast<double>(bits >> 11) * ziggurat_scale *
+			t.x[i] };
+
+		// inside the layer's rectangle
+		if(x < t.x[i + 1])
+			return sign * x;
+
+		if(i == 0)
+		{
+			// the tail (Marsaglia, Technometrics 6, 101 (1964))
+			double a, b;
+			do
+			{
+				a = -std::log(1. - uniform(engine)) / normal_r;
+				b = -std::log(1. - uniform(engine));
+			} while(2. * b < a * a);
+
+			return sign * (normal_r + a);
+		}
+
+		// the wedge between the rectangle and the density
+		if(t.f[i + 1] + (t.f[i] - t.f[i + 1]) * uniform(engine) <
+			normal_pdf(x))
+		{
+			return sign * x;
+		}
+
+		bits = engine();
+	}
+}
+
+/**
+ * \brief Generates a standard exponential random number, starting from one
+ *    output of the engine.
+ *
+ * \param[in] engine The random number engine, for the rejected cases.
+ * \param[in] bits The first output of the engine to use.
+ * \return The random number.
+ */
+static inline double exponential_from_bits(Engine &engine,
+	std::uint64_t bits)
+{
+	const ZigguratTables &t = exponential_tables;
+
+	while(true)
+	{
+		const std::size_t i{ static_cast<std::size_t>(bits & 0xff) };
+		const double x{ static_cast<double>(bits >> 11) * ziggurat_scale *
+			t.x[i] };
+
+		if(x < t.x[i + 1])
+			return x;
+
+		// the tail is another exponential
+		if(i == 0)
+			return exponential_r - std::log(1. - uniform(engine));
+
+		if(t.f[i + 1] + (t.f[i] - t.f[i + 1]) * uniform(engine) <
+			exponential_pdf(x))
+		{
+			return x;
+		}
+
+		bits = engine();
+	}
+}
+
+double zigguratNormal(Engine &engine)
+{
+	return normal_from_bits(engine, engine());
+}
+
+void zigguratNormalN(Engine &engine, double *z, std::size_t n)
+{
+	Engine::result_type bits[sample_block];
+
+	for(std::size_t start = 0; start < n; start += sample_block)
+	{
+		const std::size_t m{ std::min(sample_block, n - start) };
+
+		engine.generate(bits, m);
+		for(std::size_t k = 0; k < m; ++k)
+			z[start + k] = normal_from_bits(engine, bits[k]);
+	}
+}
+
+double zigguratExponential(Engine &engine)
+{
+	return exponential_from_bits(engine, engine());
+}
+
+void zigguratExponentialN(Engine &engine, double *e, std::size_t n)
+{
+	Engine::result_type bits[sample_block];
+
+	for(std::size_t start = 0; start < n; start += sample_block)
+	{
+		const std::size_t m{ std::min(sample_block, n - start) };
+
+		engine.generate(bits, m);
+		for(std::size_t k = 0; k < m; ++k)
+			e[start + k] = exponential_from_bits(engine, bits[k]);
+	}
+}
+
+} // namespace molstat
@@ -0,0 +1,70 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file ziggurat.h
+ * \brief Ziggurat generators for standard normal and exponential random
+ *    numbers.
+ *
+ * The ziggurat method (Marsaglia and Tsang, J. Stat. Softw. 5(8), 2000)
+ * covers the density with 256 layers of equal area. One output of the engine
+ * chooses a layer (the low 8 bits) and a position in the layer (the top 53
+ * bits); the position is accepted with a single comparison about 99% of the
+ * time. Only the remaining cases evaluate the density or sample the tail.
+ * Using independent bits for the layer and the position avoids the
+ * correlation of the original method (Doornik, 2005).
+ */
+
+#ifndef __ziggurat_h__
+#define __ziggurat_h__
+
+#include <cstddef>
+#include "engine.h"
+
+namespace molstat {
+
+/**
+ * \brief Generates a standard normal random number (mean 0 and standard
+ *    deviation 1) with the ziggurat method.
+ *
+ * \param[in] engine The random number engine.
+ * \return The random number.
+ */
+double zigguratNormal(Engine &engine);
+
+/**
+ * \brief Generates standard normal random numbers with the ziggurat method.
+ *
+ * The engine outputs for the numbers are drawn in blocks; the rare cases that
+ * need more draw them from the engine after the block.
+ *
+ * \param[in] engine The random number engine.
+ * \param[out] z Storage for the random numbers.
+ * \param[in] n The number of random numbers.
+ */
+void zigguratNormalN(Engine &engine, double *z, std::size_t n);
+
+/**
+ * \brief Generates a standard exponential random number (rate 1) with the
+ *    ziggurat method.
+ *
+ * \param[in] engine The random number engine.
+ * \return The random number.
+ */
+double zigguratExponential(Engine &engine);
+
+/**
+ * \brief Generates standard exponential random numbers with the ziggurat
+ *    method.
+ *
+ * \param[in] engine The random number engine.
+ * \param[out] e Storage for the random numbers.
+ * \param[in] n The number of random numbers.
+ */
+void zigguratExponentialN(Engine &engine, double *e, std::size_t n);
+
+} // namespace molstat
+
+#endif
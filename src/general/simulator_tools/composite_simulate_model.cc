@@ -14,65 +14,101 @@
 
 #include "simulate_model.h"
 #include "simulator_exceptions.h"
+#include <algorithm>
 
 namespace molstat {
 
-CompositeSimulateModel::SubmodelParameters
-CompositeSimulateModel::routeSubmodelParameters(
-	const std::valarray<double> &cparams) const
+thread_local std::size_t CompositeSimulateModel::SubmodelScratch::depth{ 0 };
+
+thread_local std::deque<std::vector<std::valarray<double>>>
+	CompositeSimulateModel::SubmodelScratch::pool;
+
+CompositeSimulateModel::SubmodelScratch::SubmodelScratch(
+	std::size_t nsubmodels)
+	: buffers(depth < pool.size() ? pool[depth] : (pool.emplace_back(),
+		pool.back()))
 {
-	SubmodelParameters ret;
+	++depth;
 
-	// go through all of the submodels
-	// submodel.first is the pointer to the submodel
-	// submodel.second is the list of indices
-	for(const auto submodel : submodels)
-		ret.emplace_back(std::make_pair(
-			submodel.first,
-			cparams[submodel.second]));
+	if(buffers.size() < nsubmodels)
+		buffers.resize(nsubmodels);
+}
 
-	return ret;
+CompositeSimulateModel::SubmodelScratch::~SubmodelScratch()
+{
+	--depth;
 }
 
-std::size_t CompositeSimulateModel::get_num_composite_parameters() const
+void CompositeSimulateModel::getSubmodelParameters(
+	const std::valarray<double> &cparams, const SubmodelLayout &sub,
+	std::valarray<double> &sparams) const
 {
-	return get_names().size();
+	const double *source{ &cparams[0] };
+	double *dest{ &sparams[0] };
+
+	// the composite model's parameters, then the submodel's span
+	std::copy(source, source + num_composite_parameters, dest);
+	std::copy(source + sub.offset, source + sub.offset + sub.length,
+		dest + num_composite_parameters);
 }
 
-std::size_t CompositeSimulateModel::get_num_parameters() const
+CompositeSimulateModel::SubmodelParameters
+CompositeSimulateModel::routeSubmodelParameters(
+	const std::valarray<double> &cparams) const
 {
-	// first get the number of parameters required directly
-	std::size_t ret{ get_num_composite_parameters() };
+	SubmodelParameters ret;
 
-	// add in the parameters for each submodel
-	for(const auto submodel : submodels)
-		ret += submodel.first->get_num_parameters();
+	// go through all of the submodels
+	for(std::size_t s = 0; s < submodels.size(); ++s)
+	{
+		std::valarray<double> sparams(
+			num_composite_parameters + layout[s].length);
+		getSubmodelParameters(cparams, layout[s], sparams);
+
+		ret.emplace_back(submodels[s], std::move(sparams));
+	}
 
 	return ret;
 }
 
-std::valarray<double> CompositeSimulateModel::generateParameters(
-	Engine &engine) const
+void CompositeSimulateModel::fillParameters(Engine &engine, double *params)
+	const
 {
-	std::size_t tally = get_num_composite_parameters();
-	std::valarray<double> ret(get_num_parameters());
-
 	// simulate the parameters for the composite model
-	for(std::size_t j = 0; j < tally; ++j)
+	for(std::size_t j = 0; j < num_composite_parameters; ++j)
 	{
-		ret[j] = dists[j]->sample(engine);
+		params[j] = dists[j]->sample(engine);
 	}
 
 	// go through the submodels, having them simulate their respective parameters
-	for(const auto submodel : submodels)
+	for(const SubmodelLayout &sub : layout)
+		sub.model->fillParameters(engine, params + sub.offset);
+}
+
+void CompositeSimulateModel::fillParametersBatch(Engine &engine,
+	std::size_t n, double *params) const
+{
+	// simulate the parameters for the composite model
+	for(std::size_t j = 0; j < num_composite_parameters; ++j)
 	{
-		std::size_t submodel_length = submodel.first->get_num_parameters();
+		dists[j]->sampleN(engine, params + j * n, n);
+	}
+
+	// go through the submodels, having them simulate their respective parameters
+	for(const SubmodelLayout &sub : layout)
+		sub.model->fillParametersBatch(engine, n, params + sub.offset * n);
+}
 
-		ret[std::slice(tally, submodel_length, 1)]
-			= submodel.first->generateParameters(engine);
+std::vector<std::string> CompositeSimulateModel::getParameterNames() const
+{
+	std::vector<std::string> ret{ get_names() };
+
+	for(std::size_t s = 0; s < layout.size(); ++s)
+	{
+		const std::string prefix{ "submodel" + std::to_string(s + 1) + '.' };
 
-		// move the tally index up for the next model
-		tally += submodel_length;
+		for(const std::string &name : layout[s].model->getParameterNames())
+			ret.emplace_back(prefix + name);
 	}
 
 	return ret;
@@ -16,10 +16,13 @@
 #ifndef __observable_h__
 #define __observable_h__
 
+#include <cmath>
+#include <limits>
 #include <list>
 #include <memory>
 #include <utility>
 #include <valarray>
+#include <vector>
 #include <typeinfo>
 #include <typeindex>
 #include <functional>
@@ -44,23 +47,53 @@ namespace molstat {
  * the molstat::SimulateModel, letting the runtime know that the model and
  * observable are \"compatible\".
  *
- * The observable function of the subclass may throw
- * molstat::NoObservableProduced if the specified set of model parameters does
- * not result in the observable being emitted by the system. (Not all models
- * will need this feature.) The main MolStat simulator will report the number
- * of trials that do not result in an observable.
+ * The observable function of the subclass should return a quiet NaN (e.g.,
+ * `std::numeric_limits<double>::quiet_NaN()`) if the specified set of model
+ * parameters does not result in the observable being emitted by the system.
+ * (Not all models will need this feature.) The main MolStat simulator will
+ * report the number of trials that do not result in an observable. For
+ * compatibility, the observable function may instead throw
+ * molstat::NoObservableProduced, which is converted to NaN; throwing is much
+ * slower when many trials do not produce the observable.
  *
  * \note When dealing with composite simulator models, the
  *    `CompositeObservable` class may be preferential to `Observable`. More
  *    details for `CompositeObservable` are presented in its documentation.
  *
  * \tparam T The derived class for a specific observable. This is designed to
- *    be a \"curiously recurring template pattern\".
+ *    be a \"curiously recurring template pattern\"; `T` must derive
+ *    (non-virtually) from `Observable<T>`.
  */
 template<typename T>
 class Observable
 	: public virtual SimulateModel
 {
+private:
+	/// Member pointer to the observable function.
+	double (T::*const obsfunc)(const std::valarray<double> &) const;
+
+	/**
+	 * \brief The molstat::ObservableKernel function for this observable.
+	 *
+	 * \param[in] context Pointer to the `Observable<T>` part of the model.
+	 * \param[in] params The model parameters.
+	 * \return The observable, or NaN if it is not produced.
+	 */
+	static double kernel(const void *context,
+		const std::valarray<double> &params)
+	{
+		const Observable<T> *obs = static_cast<const Observable<T> *>(context);
+
+		try
+		{
+			return (static_cast<const T *>(obs)->*(obs->obsfunc))(params);
+		}
+		catch(const NoObservableProduced &e)
+		{
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+	}
+
 public:
 	Observable() = delete;
 	virtual ~Observable() = default;
@@ -81,15 +114,23 @@ public:
 	 * if the model and observable are incompatible. If used as intended
 	 * (`this` is used; see above), this should not happen.
 	 *
-	 * \param[in] obsfunc Member pointer to the observable function.
+	 * A molstat::ObservableKernel for the observable is also registered so
+	 * that molstat::SimulationPlan can call the function directly.
+	 *
+	 * \param[in] obsfunc_ Member pointer to the observable function.
 	 */
-	Observable(double (T::*obsfunc)(const std::valarray<double> &) const)
+	Observable(double (T::*obsfunc_)(const std::valarray<double> &) const)
+		: obsfunc(obsfunc_)
 	{
 		using namespace std;
 
+		// register the kernel
+		observable_kernels[GetObservableIndex<T>()] =
+			ObservableKernel{ &Observable<T>::kernel, this };
+
 		// add the function to the list of compatible observables
 		compatible_observables[GetObservableIndex<T>()] =
-			[obsfunc] (shared_ptr<const SimulateModel> model)
+			[obsfunc_] (shared_ptr<const SimulateModel> model)
 				-> ObservableFunction
 			{
 				// cast the model to the observable (derived) class
@@ -100,15 +141,95 @@ public:
 					throw IncompatibleObservable();
 
 				// make the actual Observable function
-				return [cast, obsfunc] (const std::valarray<double> &params)
+				return [cast, obsfunc_] (const std::valarray<double> &params)
 						-> double
 					{
-						return (cast.get()->*obsfunc)(params);
+						try
+						{
+							return (cast.get()->*obsfunc_)(params);
+						}
+						catch(const NoObservableProduced &e)
+						{
+							return std::numeric_limits<double>::quiet_NaN();
+						}
 					};
 			};
 	}
 };
 
+/**
+ * \brief Base class for a model that calculates several observables in one
+ *    pass.
+ *
+ * Some observables share expensive intermediate quantities. A model can
+ * derive from `FusedObservable<T, Obs...>` and implement a function of
+ * signature
+ * \code{.cpp}
+ * void T::function_name(const std::valarray<double> &params, double *obs) const
+ * \endcode
+ * that stores observable `Obs...[j]` in `obs[j]`. The model must still
+ * derive from each `Obs` (molstat::Observable); the fused function is only an
+ * optimization that molstat::SimulationPlan uses when several of the
+ * observables are requested together. The fused values must be identical to
+ * those of the individual observable functions.
+ *
+ * If the fused function throws molstat::NoObservableProduced, all of its
+ * observables are NaN.
+ *
+ * \tparam T The derived (model) class. `T` must derive (non-virtually) from
+ *    `FusedObservable<T, Obs...>`.
+ * \tparam Obs The observables calculated by the fused function.
+ */
+template<typename T, typename... Obs>
+class FusedObservable
+	: public virtual SimulateModel
+{
+private:
+	/// Member pointer to the fused function.
+	void (T::*const fusedfunc)(const std::valarray<double> &, double *) const;
+
+	/**
+	 * \brief The molstat::FusedKernel function for these observables.
+	 *
+	 * \param[in] context Pointer to the `FusedObservable` part of the model.
+	 * \param[in] params The model parameters.
+	 * \param[out] obs The observables.
+	 */
+	static void kernel(const void *context,
+		const std::valarray<double> &params, double *obs)
+	{
+		const FusedObservable<T, Obs...> *fused =
+			static_cast<const FusedObservable<T, Obs...> *>(context);
+
+		try
+		{
+			(static_cast<const T *>(fused)->*(fused->fusedfunc))(params, obs);
+		}
+		catch(const NoObservableProduced &e)
+		{
+			for(std::size_t j = 0; j < sizeof...(Obs); ++j)
+				obs[j] = std::numeric_limits<double>::quiet_NaN();
+		}
+	}
+
+public:
+	FusedObservable() = delete;
+	virtual ~FusedObservable() = default;
+
+	/**
+	 * \brief Constructor that registers the fused function.
+	 *
+	 * \param[in] fusedfunc_ Member pointer to the fused function.
+	 */
+	FusedObservable(void (T::*fusedfunc_)(const std::valarray<double> &,
+		double *) const)
+		: fusedfunc(fusedfunc_)
+	{
+		fused_kernels.push_back(FusedKernel{ { GetObservableIndex<Obs>()... },
+			&FusedObservable<T, Obs...>::kernel, this });
+	}
+};
+
 /**
  * \brief Base class for a composite observable; that is, an observable that
  *    is calculated from several submodels (used in conjunction with
@@ -146,7 +267,9 @@ protected:
 	 *
 	 * Create the function that calculates the observable \c T using the
 	 * submodels. The observable from each submodel is calculated and all
-	 * "sub-observables" are combined using the specified operation.
+	 * "sub-observables" are combined using the specified operation. If any
+	 * submodel does not produce the observable (it returns NaN), the
+	 * composite observable is NaN.
 	 *
 	 * \throw molstat::IncompatibleObservable if any of the underlying submodels
 	 *    are incompatible with the observable.
@@ -180,49 +303,58 @@ protected:
 		if(cmodel->submodels.size() == 0)
 			throw NoSubmodels();
 
-		// construct a list of submodel information; that is, a list of
-		// parameters to pass to each submodel as well as the observable
-		// function.
-		std::list<std::pair<const std::valarray<size_t>,
-		                    ObservableFunction>>
+		// construct a list of submodel information; that is, the location of
+		// each submodel's parameters and its observable function.
+		std::vector<std::pair<CompositeSimulateModel::SubmodelLayout,
+		                      ObservableFunction>>
 			subinfo;
+		subinfo.reserve(cmodel->submodels.size());
 
 		// go through all of the submodels
-		for(const auto submodel : cmodel->submodels)
+		for(std::size_t s = 0; s < cmodel->submodels.size(); ++s)
 		{
 			// getObservableFunction will throw IncompatibleObservable if
 			// this submodel is incompatible with the observable. let this
 			// exception pass up to the caller
-			subinfo.emplace_back(make_pair(
-				submodel.second,
-				submodel.first->getObservableFunction(oindex)));
+			subinfo.emplace_back(cmodel->layout[s],
+				cmodel->submodels[s]->getObservableFunction(oindex));
 		}
 
 		// make the actual Observable function for the composite observable.
 		// this function goes through each submodel, calculates each
 		// "sub-observable", and combines them using the specified operation
-		return [oper, subinfo] (const std::valarray<double> &params)
+		return [oper, subinfo, cmodel] (const std::valarray<double> &params)
 				-> double
 			{
 				double ret{ 0. };
-				bool isfirst{ true };
+
+				// reuse this thread's buffers for the submodel parameters
+				CompositeSimulateModel::SubmodelScratch scratch(subinfo.size());
+				const std::size_t ncomp{ cmodel->get_num_composite_parameters() };
 
 				// go through the submodels:
 				// calculate the observable of each and combine them using
 				// the specified operation
-				for(const auto modelinfo : subinfo)
+				for(std::size_t s = 0; s < subinfo.size(); ++s)
 				{
-					// modelinfo.first has a valarray that filters out the
-					// correct model parameters to send to the submodel.
+					const auto &modelinfo = subinfo[s];
+
+					// modelinfo.first locates the submodel's parameters.
 					// modelinfo.second is the function
-					double obs = modelinfo.second(params[modelinfo.first]);
+					std::valarray<double> &subparams =
+						scratch.get(s, ncomp + modelinfo.first.length);
+					cmodel->getSubmodelParameters(params, modelinfo.first,
+						subparams);
 
-					if(isfirst)
-					{
-						// ret is uninitialized
+					double obs = modelinfo.second(subparams);
+
+					// if any submodel does not produce the observable, neither
+					// does the composite model
+					if(std::isnan(obs))
+						return obs;
+
+					if(s == 0)
 						ret = obs;
-						isfirst = false;
-					}
 					else
 						ret = oper(ret, obs);
 				}
@@ -264,6 +396,9 @@ public:
 		// add the function to the list of compatible observables
 		compatible_observables[oindex] = std::bind(
 			getCompositeObservableFunction, oper, _1);
+
+		// register the operation for molstat::SimulationPlan
+		composite_operations[oindex] = oper;
 	}
 };
 
@@ -22,11 +22,6 @@ SimulateModelType SimulateModel::getModelType() const
 	return std::type_index{ typeid(SimulateModel) };
 }
 
-std::size_t SimulateModel::get_num_parameters() const
-{
-	return get_names().size();
-}
-
 ObservableFunction SimulateModel::getObservableFunction(
 	const ObservableIndex &obs) const
 {
@@ -47,15 +42,37 @@ ObservableFunction SimulateModel::getObservableFunction(
 
 std::valarray<double> SimulateModel::generateParameters(Engine &engine) const
 {
-	const std::size_t length = get_num_parameters();
-	std::valarray<double> ret(length);
+	std::valarray<double> ret(get_num_parameters());
+
+	fillParameters(engine, &ret[0]);
+
+	return ret;
+}
+
+void SimulateModel::fillParameters(Engine &engine, double *params) const
+{
+	const std::size_t length = dists.size();
 
 	for(std::size_t j = 0; j < length; ++j)
 	{
-		ret[j] = dists[j]->sample(engine);
+		params[j] = dists[j]->sample(engine);
 	}
+}
 
-	return ret;
+void SimulateModel::fillParametersBatch(Engine &engine, std::size_t n,
+	double *params) const
+{
+	const std::size_t length = dists.size();
+
+	for(std::size_t j = 0; j < length; ++j)
+	{
+		dists[j]->sampleN(engine, params + j * n, n);
+	}
+}
+
+std::vector<std::string> SimulateModel::getParameterNames() const
+{
+	return get_names();
 }
 
 } // namespace molstat
@@ -44,6 +44,7 @@
 #include <map>
 #include <set>
 #include <list>
+#include <deque>
 #include <typeinfo>
 #include <typeindex>
 #include <general/random_distributions/rng.h>
@@ -58,12 +59,82 @@ class RandomDistribution;
 /**
  * \brief The signature of a function that calculates an observable.
  *
- * A molstat::ObservableFunction may throw molstat::NoObservableProduced if
- * the specified set of model parameters does not result in the observable.
+ * A molstat::ObservableFunction returns a quiet NaN if the specified set of
+ * model parameters does not result in the observable. The functions produced
+ * by molstat::Observable and molstat::CompositeObservable never throw
+ * molstat::NoObservableProduced; they convert it to NaN.
  */
 using ObservableFunction =
 	std::function<double(const std::valarray<double> &)>;
 
+/**
+ * \brief A directly-callable function that calculates an observable for a
+ *    specific model.
+ *
+ * This is a lightweight alternative to molstat::ObservableFunction that is
+ * used by molstat::SimulationPlan: `function` is a plain function pointer and
+ * `context` points to the model (or the relevant part of it). Like an
+ * ObservableFunction, it returns NaN if the observable is not produced.
+ */
+struct ObservableKernel
+{
+	/// The function, called with `context` and the model parameters.
+	double (*function)(const void *context, const std::valarray<double> &);
+
+	/// The model-specific context.
+	const void *context;
+
+	/**
+	 * \brief Calculates the observable.
+	 *
+	 * \param[in] params The model parameters.
+	 * \return The observable.
+	 */
+	double operator()(const std::valarray<double> &params) const
+	{
+		return function(context, params);
+	}
+};
+
+/**
+ * \brief A directly-callable function that calculates several observables
+ *    for a specific model in one pass.
+ *
+ * Some observables share expensive intermediate quantities (e.g., the
+ * static conductance is the electric current divided by the bias). When
+ * several of these observables are requested, molstat::SimulationPlan calls
+ * the fused kernel once instead of each observable's kernel. The values must
+ * be identical to those of the individual kernels. Like an
+ * ObservableKernel, a fused kernel produces NaN for any observable that is
+ * not produced.
+ */
+struct FusedKernel
+{
+	/// The observables calculated by the kernel, in order.
+	std::vector<std::type_index> observables;
+
+	/**
+	 * \brief The function, called with `context`, the model parameters, and
+	 *    storage for the observables (in the order of `observables`).
+	 */
+	void (*function)(const void *context, const std::valarray<double> &,
+		double *);
+
+	/// The model-specific context.
+	const void *context;
+
+	/**
+	 * \brief Calculates the observables.
+	 *
+	 * \param[in] params The model parameters.
+	 * \param[out] obs The observables, in the order of `observables`.
+	 */
+	void operator()(const std::valarray<double> &params, double *obs) const
+	{
+		function(context, params, obs);
+	}
+};
+
 /**
  * \brief The signature of a function that produces an ObservableFunction,
  *    given the model.
@@ -120,12 +191,36 @@ protected:
 	 */
 	std::map<ObservableIndex, ObservableFactory> compatible_observables;
 
+	/**
+	 * \brief Kernels for the observables that this model calculates
+	 *    directly (registered by molstat::Observable).
+	 *
+	 * The map is keyed by the molstat::ObservableIndex for the observable's
+	 * class.
+	 */
+	std::map<ObservableIndex, ObservableKernel> observable_kernels;
+
+	/**
+	 * \brief Kernels that calculate several observables at once (registered
+	 *    by molstat::FusedObservable).
+	 */
+	std::vector<FusedKernel> fused_kernels;
+
 	/**
 	 * \brief Ordered vector of random number distributions for the various
 	 *    model parameters.
 	 */
 	std::vector<std::shared_ptr<const RandomDistribution>> dists;
 
+	/**
+	 * \brief The number of model parameters (including those of any
+	 *    submodels).
+	 *
+	 * This is set by molstat::SimulateModelFactory so that the virtual
+	 * get_names() does not need to be called while simulating.
+	 */
+	std::size_t num_parameters{ 0 };
+
 	/**
 	 * \brief Gets a map of parameter name to index.
 	 *
@@ -153,10 +248,26 @@ public:
 	/**
 	 * \brief Gets the number of model parameters for this model.
 	 *
+	 * For composite models, this includes the parameters of all submodels.
+	 *
 	 * \return The number of parameters used by the model for calculating
 	 *    observables.
 	 */
-	virtual std::size_t get_num_parameters() const;
+	std::size_t get_num_parameters() const noexcept
+	{
+		return num_parameters;
+	}
+
+	/**
+	 * \brief Gets the names of the model parameters, in the order they are
+	 *    generated.
+	 *
+	 * For composite models, the names of each submodel's parameters are
+	 * prefixed by the submodel (e.g., `submodel1.`).
+	 *
+	 * \return The names of the get_num_parameters() parameters.
+	 */
+	virtual std::vector<std::string> getParameterNames() const;
 
 	/**
 	 * \brief Gets a function that calculates an observable, given a set of
@@ -180,10 +291,40 @@ public:
 	 * \param[in] engine The C++11 random number engine.
 	 * \return A set of model parameters.
 	 */
-	virtual std::valarray<double> generateParameters(Engine &engine) const;
+	std::valarray<double> generateParameters(Engine &engine) const;
+
+	/**
+	 * \brief Generates a set of model parameters in caller-provided storage.
+	 *
+	 * This is the non-allocating version of generateParameters(); the random
+	 * numbers are drawn in the same order.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[out] params Storage for (at least) get_num_parameters() values.
+	 */
+	virtual void fillParameters(Engine &engine, double *params) const;
+
+	/**
+	 * \brief Generates the model parameters for a batch of trials.
+	 *
+	 * The parameters are stored column-major: parameter `i` of trial `k` is
+	 * stored at `params[i*n + k]`. Each parameter is drawn for the whole
+	 * batch with one call to RandomDistribution::sampleN, so the random
+	 * numbers are not the same as those from `n` calls to fillParameters().
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[in] n The number of trials.
+	 * \param[out] params Storage for get_num_parameters() columns of `n`
+	 *    values.
+	 */
+	virtual void fillParametersBatch(Engine &engine, std::size_t n,
+		double *params) const;
 
 	// the factory needs to get at the internal details
 	friend class SimulateModelFactory;
+
+	// the simulation plan needs the kernels
+	friend class SimulationPlan;
 };
 
 /**
@@ -226,18 +367,129 @@ protected:
 	CompositeSimulateModel() = default;
 
 	/**
-	 * \brief List of the underlying submodels.
+	 * \brief The underlying submodels.
 	 *
-	 * Each element in the list corresponds to a submodel; this list also helps
-	 * route the correct model parameters from the composite model to each
-	 * submodel.
+	 * The parameters for each submodel are routed from the composite model's
+	 * parameters using `layout`.
+	 */
+	std::vector<std::shared_ptr<SimulateModel>> submodels;
+
+	/**
+	 * \brief Location of a submodel's parameters within the composite model's
+	 *    parameters.
 	 *
-	 * The first element is a pointer to the submodel and the second element is
-	 * an array of the indices of composite model parameters for that submodel.
+	 * A submodel's parameters are the composite model's parameters
+	 * (`[0, get_num_composite_parameters())`), followed by the contiguous
+	 * span `[offset, offset + length)` of the composite model's parameters.
+	 */
+	struct SubmodelLayout
+	{
+		/// The submodel.
+		const SimulateModel *model;
+
+		/// Index of the submodel's first parameter in the composite model.
+		std::size_t offset;
+
+		/// The number of parameters for the submodel.
+		std::size_t length;
+	};
+
+	/**
+	 * \brief The parameter layout of each submodel, in the same order as
+	 *    `submodels`.
+	 *
+	 * This is frozen by SimulateModelFactory::getModel().
+	 */
+	std::vector<SubmodelLayout> layout;
+
+	/// The number of model parameters needed directly by the composite model.
+	std::size_t num_composite_parameters{ 0 };
+
+	/**
+	 * \brief The operations used to combine the submodels' observables for
+	 *    each composite observable (registered by
+	 *    molstat::CompositeObservable).
+	 */
+	std::map<ObservableIndex, std::function<double(double, double)>>
+		composite_operations;
+
+	/**
+	 * \brief Composite observables that are the observable of a single
+	 *    submodel.
+	 *
+	 * The function selects the submodel; the first submodel it accepts
+	 * calculates the observable. molstat::SimulationPlan then uses that
+	 * submodel's kernel (possibly fused with the submodel's other requested
+	 * observables) instead of the composite model's
+	 * molstat::ObservableFunction, which must give the same value.
+	 */
+	std::map<ObservableIndex, std::function<bool(const SimulateModel &)>>
+		forwarded_observables;
+
+	/**
+	 * \brief Copies the parameters for a submodel out of the composite
+	 *    model's parameters.
+	 *
+	 * \param[in] cparams The composite model's parameters.
+	 * \param[in] sub The submodel's layout.
+	 * \param[out] sparams The submodel's parameters. This must already have
+	 *    the correct size (get_num_composite_parameters() + sub.length).
 	 */
-	std::list<std::pair<std::shared_ptr<SimulateModel>,
-		                  const std::valarray<std::size_t>>>
-		submodels;
+	void getSubmodelParameters(const std::valarray<double> &cparams,
+		const SubmodelLayout &sub, std::valarray<double> &sparams) const;
+
+	/**
+	 * \brief Reusable, thread-local storage for submodel parameters.
+	 *
+	 * Calculating a composite observable requires a set of parameters for
+	 * each submodel. Rather than allocate these on every call, each thread
+	 * keeps a pool of buffers. Because composite models may be nested, the
+	 * pool is a stack indexed by the nesting depth; constructing a
+	 * SubmodelScratch claims the next level and destroying it releases the
+	 * level.
+	 */
+	class SubmodelScratch
+	{
+	private:
+		/// The current nesting depth for this thread.
+		static thread_local std::size_t depth;
+
+		/// The buffers for each depth (and submodel) for this thread.
+		static thread_local std::deque<std::vector<std::valarray<double>>>
+			pool;
+
+		/// The buffers for this level.
+		std::vector<std::valarray<double>> &buffers;
+
+	public:
+		/**
+		 * \brief Claims a level of the pool.
+		 *
+		 * \param[in] nsubmodels The number of submodels at this level.
+		 */
+		SubmodelScratch(std::size_t nsubmodels);
+
+		/// Releases the level.
+		~SubmodelScratch();
+
+		SubmodelScratch(const SubmodelScratch &) = delete;
+		SubmodelScratch &operator=(const SubmodelScratch &) = delete;
+
+		/**
+		 * \brief Gets the buffer for a submodel.
+		 *
+		 * \param[in] s The submodel.
+		 * \param[in] size The number of parameters for the submodel.
+		 * \return The buffer, with the specified size.
+		 */
+		std::valarray<double> &get(std::size_t s, std::size_t size)
+		{
+			std::valarray<double> &ret = buffers[s];
+			if(ret.size() != size)
+				ret.resize(size);
+			return ret;
+		}
+	};
 
 public:
 	virtual ~CompositeSimulateModel() = default;
@@ -268,6 +520,9 @@ public:
 	 * \brief Partition a set of parameters for the composite model into
 	 *    sets of parameters for each submodel.
 	 *
+	 * This function allocates a new set of parameters for each submodel;
+	 * performance-critical code should use the submodel `layout` directly.
+	 *
 	 * \param[in] cparams The set of composite model parameters.
 	 * \return A \c SubmodelParameters list associating each submodel with the
 	 *    parameters that should be passed to it.
@@ -279,31 +534,48 @@ public:
 	 * \brief Gets the number of model parameters needed directly by the
 	 *    composite model.
 	 */
-	std::size_t get_num_composite_parameters() const;
+	std::size_t get_num_composite_parameters() const noexcept
+	{
+		return num_composite_parameters;
+	}
 
 	/**
-	 * \brief Gets the number of model parameters for this model.
+	 * \brief Generates a set of model parameters in caller-provided storage.
 	 *
-	 * This accumulates all submodel parameters as well as any parameters
-	 * required by the composite model itself.
+	 * This override samples from the distributions required by the composite
+	 * model, as well as all distributions for the submodels.
 	 *
-	 * \return The number of parameters used by the model for calculating
-	 *    observables.
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[out] params Storage for (at least) get_num_parameters() values.
 	 */
-	virtual std::size_t get_num_parameters() const override final;
+	virtual void fillParameters(Engine &engine, double *params) const
+		override final;
 
 	/**
-	 * \brief Generates a set of model parameters using the specified random
-	 *    distributions.
+	 * \brief Generates the model parameters for a batch of trials.
 	 *
-	 * This override samples from the distributions required by the composite
-	 * model, as well as all distributions for the submodels.
+	 * This override draws the composite model's parameters, and then has
+	 * each submodel draw its parameters.
 	 *
 	 * \param[in] engine The C++11 random number engine.
-	 * \return A set of model parameters.
+	 * \param[in] n The number of trials.
+	 * \param[out] params Storage for get_num_parameters() columns of `n`
+	 *    values.
 	 */
-	virtual std::valarray<double> generateParameters(Engine &engine) const
-		override final;
+	virtual void fillParametersBatch(Engine &engine, std::size_t n,
+		double *params) const override final;
+
+	/**
+	 * \brief Gets the names of the model parameters, in the order they are
+	 *    generated.
+	 *
+	 * The composite model's parameters are followed by those of each
+	 * submodel, which are prefixed by `submodel` and the submodel's number
+	 * (starting from 1).
+	 *
+	 * \return The names of the get_num_parameters() parameters.
+	 */
+	virtual std::vector<std::string> getParameterNames() const override final;
 
 	// the factory needs to get at the internal details
 	friend class SimulateModelFactory;
@@ -311,6 +583,9 @@ public:
 	// the CompositeObservable class needs to get at the submodel information
 	template<typename T>
 	friend class CompositeObservable;
+
+	// the simulation plan needs the submodel layout and operations
+	friend class SimulationPlan;
 };
 
 /**
@@ -411,7 +686,9 @@ public:
 	  * \brief Returns the constructed model.
 	  *
 	  * Some runtime error checking, such as making sure all distributions are
-	  * specified is performed here.
+	  * specified is performed here. The layout of the model's parameters
+	  * (including any submodels) is also frozen here, so that generating
+	  * parameters does not require any allocation.
 	  *
 	  * \throw molstat::MissingDistribution if one of the required distributions
 	  *    has not been specified.
@@ -476,8 +753,13 @@ SimulateModelFactory SimulateModelFactory::makeFactory()
 	for(const std::string &iter : factory.model_names)
 		factory.remaining_names.emplace(to_lower(iter));
 
-	// set the size of the model's vector of distributions
-	factory.model->dists.resize(factory.model->get_num_parameters());
+	// set the number of parameters and the size of the model's vector of
+	// distributions. the composite model's parameters come first; those of
+	// any submodels are added with addSubmodel
+	factory.model->num_parameters = factory.model_names.size();
+	if(factory.comp_model != nullptr)
+		factory.comp_model->num_composite_parameters = factory.model_names.size();
+	factory.model->dists.resize(factory.model_names.size());
 
 	return factory;
 }
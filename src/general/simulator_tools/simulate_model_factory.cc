@@ -21,7 +21,7 @@ SimulateModelFactory &SimulateModelFactory::setDistribution(std::string name,
 	bool *used_dist /* = nullptr */)
 {
 	// set the distribution in the model
-	const std::size_t length = model->get_num_parameters();
+	const std::size_t length = model_names.size();
 	const std::string lower_name{ to_lower(name) };
 
 	if(used_dist != nullptr)
@@ -58,21 +58,9 @@ SimulateModelFactory &SimulateModelFactory::addSubmodel(
 	if(submodel_add->getModelType() != comp_model->getSubmodelType())
 		throw IncompatibleSubmodel();
 
-	// determine the parameter indices needed for this submodel
-	const std::size_t cnparam{ comp_model->get_num_composite_parameters() };
-	const std::size_t snparam{ submodel_add->get_num_parameters() };
-	const std::size_t offset{ comp_model->get_num_parameters() };
-
-	std::valarray<std::size_t> sub_params( cnparam + snparam );
-	// indices from the composite model
-	for(std::size_t j = 0; j < cnparam; ++j)
-		sub_params[j] = j;
-	// indices from the submodel
-	for(std::size_t j = 0; j < snparam; ++j)
-		sub_params[j + cnparam] = offset + j;
-
-	// add the model
-	comp_model->submodels.emplace_back(submodel_add, std::move(sub_params));
+	// add the model; its parameters follow those already in the model
+	comp_model->submodels.emplace_back(submodel_add);
+	comp_model->num_parameters += submodel_add->get_num_parameters();
 
 	return *this;
 }
@@ -88,6 +76,22 @@ std::shared_ptr<SimulateModel> SimulateModelFactory::getModel()
 	if(comp_model != nullptr && comp_model->submodels.size() == 0)
 		throw NoSubmodels();
 
+	// freeze the parameter layout of the submodels
+	if(comp_model != nullptr)
+	{
+		std::size_t offset{ comp_model->num_composite_parameters };
+
+		comp_model->layout.clear();
+		comp_model->layout.reserve(comp_model->submodels.size());
+		for(const auto &submodel : comp_model->submodels)
+		{
+			const std::size_t length{ submodel->get_num_parameters() };
+
+			comp_model->layout.push_back({ submodel.get(), offset, length });
+			offset += length;
+		}
+	}
+
 	return model;
 }
 
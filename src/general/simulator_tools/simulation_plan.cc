@@ -0,0 +1,316 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file simulation_plan.cc
+ * \brief Implements the molstat::SimulationPlan class.
+ */
+
+#include "simulation_plan.h"
+#include "simulator_exceptions.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace molstat {
+
+SimulationPlan::SimulationPlan(const SimulateModel &model,
+	const std::vector<ObservableIndex> &observables)
+	: observables(observables)
+{
+	// buffer 0 is the full set of parameters
+	std::vector<std::size_t> indices(model.get_num_parameters());
+	for(std::size_t j = 0; j < indices.size(); ++j)
+		indices[j] = j;
+	buffers.push_back({ indices, {} });
+
+	programs.resize(observables.size());
+	for(std::size_t j = 0; j < observables.size(); ++j)
+		compile(model, indices, observables[j], programs[j], 0);
+}
+
+std::size_t SimulationPlan::getBuffer(const std::vector<std::size_t> &indices)
+{
+	// reuse a buffer if one already has these parameters
+	for(std::size_t b = 0; b < buffers.size(); ++b)
+	{
+		if(buffers[b].indices == indices)
+			return b;
+	}
+
+	// make a new buffer, merging the indices into contiguous copies
+	Buffer buffer{ indices, {} };
+	for(std::size_t j = 0; j < indices.size(); ++j)
+	{
+		if(buffer.copies.size() > 0 &&
+			buffer.copies.back().source + buffer.copies.back().length
+				== indices[j])
+		{
+			++buffer.copies.back().length;
+		}
+		else
+			buffer.copies.push_back({ indices[j], j, 1 });
+	}
+
+	buffers.emplace_back(std::move(buffer));
+	return buffers.size() - 1;
+}
+
+bool SimulationPlan::getFusedSlot(const SimulateModel &model,
+	std::size_t buffer, const ObservableIndex &obs, std::size_t &slot)
+{
+	// find the fused kernel that covers the most requested observables
+	const FusedKernel *best{ nullptr };
+	std::size_t bestcount{ 1 };
+
+	for(const FusedKernel &fused : model.fused_kernels)
+	{
+		if(std::find(fused.observables.begin(), fused.observables.end(), obs)
+			== fused.observables.end())
+		{
+			continue;
+		}
+
+		const std::size_t count = std::count_if(fused.observables.begin(),
+			fused.observables.end(),
+			[this] (const ObservableIndex &o) -> bool
+			{
+				return std::find(observables.begin(), observables.end(), o)
+					!= observables.end();
+			});
+
+		if(count > bestcount)
+		{
+			best = &fused;
+			bestcount = count;
+		}
+	}
+
+	if(best == nullptr)
+		return false;
+
+	const std::size_t position = std::find(best->observables.begin(),
+		best->observables.end(), obs) - best->observables.begin();
+
+	// reuse the call if this kernel is already called with these parameters
+	for(const FusedCall &call : fused_calls)
+	{
+		if(call.kernel.function == best->function &&
+			call.kernel.context == best->context && call.buffer == buffer)
+		{
+			slot = call.slot + position;
+			return true;
+		}
+	}
+
+	fused_calls.push_back({ *best, buffer, num_slots });
+	slot = num_slots + position;
+	num_slots += best->observables.size();
+	return true;
+}
+
+SimulationPlan::Reduction SimulationPlan::getReduction(
+	const std::function<double(double, double)> &oper)
+{
+	if(oper.target<std::plus<double>>() != nullptr)
+		return Reduction::Sum;
+	if(oper.target<std::multiplies<double>>() != nullptr)
+		return Reduction::Product;
+
+	return Reduction::Generic;
+}
+
+void SimulationPlan::compile(const SimulateModel &model,
+	const std::vector<std::size_t> &indices, const ObservableIndex &obs,
+	std::vector<Instruction> &program, std::size_t depth)
+{
+	Instruction inst;
+
+	// does the model calculate the observable directly?
+	const auto kernel = model.observable_kernels.find(obs);
+	if(kernel != model.observable_kernels.end())
+	{
+		inst.buffer = getBuffer(indices);
+
+		// use a fused kernel, if possible
+		if(getFusedSlot(model, inst.buffer, obs, inst.slot))
+			inst.type = Instruction::Type::Load;
+		else
+		{
+			inst.type = Instruction::Type::Kernel;
+			inst.kernel = kernel->second;
+		}
+		program.emplace_back(std::move(inst));
+		max_stack = std::max(max_stack, depth + 1);
+		return;
+	}
+
+	// is it a composite observable?
+	const CompositeSimulateModel *cmodel =
+		dynamic_cast<const CompositeSimulateModel *>(&model);
+	if(cmodel != nullptr)
+	{
+		// each submodel gets the composite model's parameters, followed by its
+		// own
+		const std::size_t ncomp{ cmodel->num_composite_parameters };
+		const auto subindices = [&indices, ncomp]
+			(const CompositeSimulateModel::SubmodelLayout &sub)
+				-> std::vector<std::size_t>
+			{
+				std::vector<std::size_t> ret(ncomp + sub.length);
+
+				for(std::size_t j = 0; j < ncomp; ++j)
+					ret[j] = indices[j];
+				for(std::size_t j = 0; j < sub.length; ++j)
+					ret[ncomp + j] = indices[sub.offset + j];
+
+				return ret;
+			};
+
+		const auto oper = cmodel->composite_operations.find(obs);
+		if(oper != cmodel->composite_operations.end())
+		{
+			if(cmodel->layout.size() == 0)
+				throw NoSubmodels();
+
+			for(std::size_t s = 0; s < cmodel->layout.size(); ++s)
+			{
+				const auto &sub = cmodel->layout[s];
+				compile(*sub.model, subindices(sub), obs, program, depth + s);
+			}
+
+			inst.type = Instruction::Type::Reduce;
+			inst.reduction = getReduction(oper->second);
+			if(inst.reduction == Reduction::Generic)
+				inst.oper = oper->second;
+			inst.count = cmodel->layout.size();
+			program.emplace_back(std::move(inst));
+			return;
+		}
+
+		// is it the observable of one submodel? if no submodel is selected,
+		// the ObservableFunction reports the problem
+		const auto forward = cmodel->forwarded_observables.find(obs);
+		if(forward != cmodel->forwarded_observables.end())
+		{
+			for(const auto &sub : cmodel->layout)
+			{
+				if(forward->second(*sub.model))
+				{
+					compile(*sub.model, subindices(sub), obs, program, depth);
+					return;
+				}
+			}
+		}
+	}
+
+	// fall back on the model's ObservableFunction
+	// getObservableFunction throws IncompatibleObservable if necessary
+	inst.type = Instruction::Type::Function;
+	inst.buffer = getBuffer(indices);
+	inst.function = model.getObservableFunction(obs);
+	program.emplace_back(std::move(inst));
+	max_stack = std::max(max_stack, depth + 1);
+}
+
+SimulationPlan::Workspace SimulationPlan::makeWorkspace() const
+{
+	Workspace ws;
+
+	ws.buffers.reserve(buffers.size());
+	for(const Buffer &buffer : buffers)
+		ws.buffers.emplace_back(buffer.indices.size());
+
+	ws.stack.resize(max_stack);
+	ws.slots.resize(num_slots);
+
+	return ws;
+}
+
+bool SimulationPlan::evaluate(Workspace &ws, double *obs, std::size_t stride)
+	const
+{
+	// fill the parameter buffers (buffer 0 is already filled)
+	const double *params{ &ws.buffers[0][0] };
+	for(std::size_t b = 1; b < buffers.size(); ++b)
+	{
+		double *dest{ &ws.buffers[b][0] };
+
+		for(const Copy &copy : buffers[b].copies)
+			std::copy(params + copy.source, params + copy.source + copy.length,
+				dest + copy.destination);
+	}
+
+	// call the fused kernels
+	for(const FusedCall &call : fused_calls)
+		call.kernel(ws.buffers[call.buffer], &ws.slots[call.slot]);
+
+	bool produced{ true };
+	double *stack{ ws.stack.data() };
+
+	for(std::size_t j = 0; j < programs.size(); ++j)
+	{
+		std::size_t top{ 0 };
+
+		for(const Instruction &inst : programs[j])
+		{
+			switch(inst.type)
+			{
+			case Instruction::Type::Kernel:
+				stack[top++] = inst.kernel(ws.buffers[inst.buffer]);
+				break;
+
+			case Instruction::Type::Function:
+				stack[top++] = inst.function(ws.buffers[inst.buffer]);
+				break;
+
+			case Instruction::Type::Load:
+				stack[top++] = ws.slots[inst.slot];
+				break;
+
+			case Instruction::Type::Reduce:
+			{
+				// combine the values from left to right, as
+				// molstat::CompositeObservable does. NaN propagates through the
+				// sum and product.
+				top -= inst.count;
+				double ret{ stack[top] };
+
+				for(std::size_t k = 1; k < inst.count; ++k)
+				{
+					switch(inst.reduction)
+					{
+					case Reduction::Sum:
+						ret += stack[top + k];
+						break;
+
+					case Reduction::Product:
+						ret *= stack[top + k];
+						break;
+
+					case Reduction::Generic:
+						if(std::isnan(ret) || std::isnan(stack[top + k]))
+							ret = std::numeric_limits<double>::quiet_NaN();
+						else
+							ret = inst.oper(ret, stack[top + k]);
+						break;
+					}
+				}
+
+				stack[top++] = ret;
+				break;
+			}
+			}
+		}
+
+		obs[j * stride] = stack[0];
+		if(std::isnan(stack[0]))
+			produced = false;
+	}
+
+	return produced;
+}
+
+} // namespace molstat
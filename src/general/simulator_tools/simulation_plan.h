@@ -0,0 +1,281 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file simulation_plan.h
+ * \brief Defines the molstat::SimulationPlan class, which flattens a model
+ *    (and its submodels) and a set of observables into a linear evaluation
+ *    plan.
+ *
+ * Calculating an observable through a molstat::ObservableFunction passes
+ * through several layers of indirection, and composite observables gather
+ * the parameters for each submodel on every call. A molstat::SimulationPlan
+ * is compiled once, when the observables are set, and consists of
+ * - a list of parameter buffers, one for each (sub)model that calculates an
+ *   observable directly, along with the contiguous ranges of the full set of
+ *   model parameters that are copied into each buffer, and
+ * - for each observable, a short postfix program of kernel calls (see
+ *   molstat::ObservableKernel) and reductions that combine the submodel
+ *   observables of a composite observable (a composite observable that is
+ *   the observable of one submodel uses that submodel's kernel), and
+ * - a list of fused kernels (see molstat::FusedKernel) that calculate
+ *   several requested observables of a (sub)model at once; these are called
+ *   before the programs, which then load the stored values.
+ */
+
+#ifndef __simulation_plan_h__
+#define __simulation_plan_h__
+
+#include <memory>
+#include <valarray>
+#include <vector>
+#include <functional>
+#include "simulate_model.h"
+
+namespace molstat {
+
+/**
+ * \brief A flattened evaluation plan for calculating a set of observables
+ *    from a model.
+ *
+ * The plan itself is immutable after construction and can be shared between
+ * threads; each thread needs its own SimulationPlan::Workspace.
+ */
+class SimulationPlan
+{
+public:
+	/// The operation used to combine submodel observables.
+	enum class Reduction
+	{
+		Sum, ///< Addition (std::plus<double>).
+		Product, ///< Multiplication (std::multiplies<double>).
+		Generic ///< Any other operation; called through std::function.
+	};
+
+	/**
+	 * \brief Per-thread storage for evaluating a plan.
+	 *
+	 * Buffer 0 holds the full set of model parameters.
+	 */
+	class Workspace
+	{
+	private:
+		/// The parameter buffers.
+		std::vector<std::valarray<double>> buffers;
+
+		/// The evaluation stack.
+		std::vector<double> stack;
+
+		/// The values calculated by the fused kernels.
+		std::vector<double> slots;
+
+		friend class SimulationPlan;
+
+	public:
+		/**
+		 * \brief Gets the storage for the full set of model parameters.
+		 *
+		 * \return The parameters.
+		 */
+		std::valarray<double> &parameters()
+		{
+			return buffers[0];
+		}
+	};
+
+private:
+	/// A contiguous copy from the full parameters to a buffer.
+	struct Copy
+	{
+		/// The first index in the full parameters.
+		std::size_t source;
+
+		/// The first index in the buffer.
+		std::size_t destination;
+
+		/// The number of parameters to copy.
+		std::size_t length;
+	};
+
+	/// Information on a parameter buffer.
+	struct Buffer
+	{
+		/// The indices (in the full parameters) of the buffer's parameters.
+		std::vector<std::size_t> indices;
+
+		/// The copies that fill the buffer.
+		std::vector<Copy> copies;
+	};
+
+	/// A call to a fused kernel.
+	struct FusedCall
+	{
+		/// The kernel.
+		FusedKernel kernel;
+
+		/// The buffer passed to the kernel.
+		std::size_t buffer;
+
+		/// The first slot where the kernel stores its observables.
+		std::size_t slot;
+	};
+
+	/// An instruction in an observable's program.
+	struct Instruction
+	{
+		/// The type of instruction.
+		enum class Type
+		{
+			Kernel, ///< Push the result of a kernel.
+			Function, ///< Push the result of an ObservableFunction.
+			Load, ///< Push a value calculated by a fused kernel.
+			Reduce ///< Combine the top `count` values on the stack.
+		} type;
+
+		/// The buffer passed to the kernel or function.
+		std::size_t buffer;
+
+		/// The kernel, for Type::Kernel.
+		ObservableKernel kernel;
+
+		/// The function, for Type::Function.
+		ObservableFunction function;
+
+		/// The reduction, for Type::Reduce.
+		Reduction reduction;
+
+		/// The operation, for Reduction::Generic.
+		std::function<double(double, double)> oper;
+
+		/// The number of values to combine, for Type::Reduce.
+		std::size_t count;
+
+		/// The slot, for Type::Load.
+		std::size_t slot;
+	};
+
+	/// The parameter buffers; buffer 0 is the full set of parameters.
+	std::vector<Buffer> buffers;
+
+	/// The program for each observable.
+	std::vector<std::vector<Instruction>> programs;
+
+	/// The maximum stack depth needed by any program.
+	std::size_t max_stack{ 0 };
+
+	/// The requested observables.
+	std::vector<ObservableIndex> observables;
+
+	/// The fused kernels to call before the programs.
+	std::vector<FusedCall> fused_calls;
+
+	/// The number of slots needed by the fused kernels.
+	std::size_t num_slots{ 0 };
+
+	/**
+	 * \brief Gets the buffer for a set of parameter indices, creating it if
+	 *    necessary.
+	 *
+	 * \param[in] indices The indices (in the full parameters) of the
+	 *    parameters in the buffer.
+	 * \return The index of the buffer.
+	 */
+	std::size_t getBuffer(const std::vector<std::size_t> &indices);
+
+	/**
+	 * \brief Finds the slot for an observable calculated by a fused kernel,
+	 *    if any.
+	 *
+	 * A fused kernel is only used if it calculates at least two of the
+	 * requested observables; the kernel covering the most requested
+	 * observables is preferred.
+	 *
+	 * \param[in] model The (sub)model.
+	 * \param[in] buffer The buffer with the model's parameters.
+	 * \param[in] obs The observable.
+	 * \param[out] slot The slot for the observable, if found.
+	 * \return True if a fused kernel is used for the observable.
+	 */
+	bool getFusedSlot(const SimulateModel &model, std::size_t buffer,
+		const ObservableIndex &obs, std::size_t &slot);
+
+	/**
+	 * \brief Appends the instructions for calculating an observable with a
+	 *    (sub)model.
+	 *
+	 * \throw molstat::IncompatibleObservable if the model is incompatible
+	 *    with the observable.
+	 *
+	 * \param[in] model The (sub)model.
+	 * \param[in] indices The indices (in the full parameters) of the model's
+	 *    parameters.
+	 * \param[in] obs The observable.
+	 * \param[in,out] program The program.
+	 * \param[in] depth The stack depth before these instructions.
+	 */
+	void compile(const SimulateModel &model,
+		const std::vector<std::size_t> &indices, const ObservableIndex &obs,
+		std::vector<Instruction> &program, std::size_t depth);
+
+	/**
+	 * \brief Detects the reduction for an operation.
+	 *
+	 * \param[in] oper The operation.
+	 * \return The reduction.
+	 */
+	static Reduction getReduction(const std::function<double(double, double)>
+		&oper);
+
+public:
+	/// Creates an empty plan (no observables).
+	SimulationPlan() = default;
+
+	/**
+	 * \brief Compiles a plan for calculating observables with a model.
+	 *
+	 * \throw molstat::IncompatibleObservable if the model is incompatible
+	 *    with one of the observables.
+	 *
+	 * \param[in] model The (full) model.
+	 * \param[in] observables The observables.
+	 */
+	SimulationPlan(const SimulateModel &model,
+		const std::vector<ObservableIndex> &observables);
+
+	/**
+	 * \brief Creates a workspace for evaluating this plan.
+	 *
+	 * \return The workspace.
+	 */
+	Workspace makeWorkspace() const;
+
+	/**
+	 * \brief Calculates the observables from the parameters in the
+	 *    workspace.
+	 *
+	 * The full set of model parameters must first be stored in
+	 * `ws.parameters()`.
+	 *
+	 * \param[in,out] ws The workspace.
+	 * \param[out] obs Observable `j` is stored in `obs[j*stride]`.
+	 * \param[in] stride The stride between observables in `obs`.
+	 * \return True if all observables were produced (none are NaN).
+	 */
+	bool evaluate(Workspace &ws, double *obs, std::size_t stride) const;
+
+	/**
+	 * \brief Gets the number of observables in the plan.
+	 *
+	 * \return The number of observables.
+	 */
+	std::size_t numObservables() const noexcept
+	{
+		return programs.size();
+	}
+};
+
+} // namespace molstat
+
+#endif
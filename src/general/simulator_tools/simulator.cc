@@ -17,7 +17,7 @@
 namespace molstat {
 
 Simulator::Simulator(std::shared_ptr<SimulateModel> model_)
-	: model(model_), obs_functions()
+	: model(model_), obs_functions(), obs_indices(), plan()
 {
 	// make sure model is not a submodel
 	if(model == nullptr)
@@ -29,21 +29,82 @@ Simulator::Simulator(std::shared_ptr<SimulateModel> model_)
 
 std::valarray<double> Simulator::simulate(Engine &engine) const
 {
-	std::size_t num_obs{ obs_functions.size() };
+	std::valarray<double> ret;
+
+	if(!simulate(engine, ret))
+		throw NoObservableProduced();
+
+	return ret;
+}
+
+bool Simulator::simulate(Engine &engine, std::valarray<double> &obs) const
+{
+	const std::size_t num_obs{ obs_functions.size() };
 
 	if(num_obs == 0)
 		throw molstat::NoObservables();
 
-	std::valarray<double> ret( num_obs );
+	if(obs.size() != num_obs)
+		obs.resize(num_obs);
 
 	// get some parameters
-	const std::valarray<double> params{ model->generateParameters(engine) };
+	SimulationPlan::Workspace ws{ plan.makeWorkspace() };
+	model->fillParameters(engine, &ws.parameters()[0]);
 
 	// calculate each of the observables
-	for(std::size_t j = 0; j < num_obs; ++j)
-		ret[j] = obs_functions[j](params);
+	return plan.evaluate(ws, &obs[0], 1);
+}
 
-	return ret;
+std::size_t Simulator::simulateBatch(Engine &engine, std::size_t n,
+	double *out, bool *produced, double *params_out /* = nullptr */) const
+{
+	const std::size_t num_obs{ obs_functions.size() };
+	const std::size_t num_params{ model->get_num_parameters() };
+
+	if(num_obs == 0)
+		throw molstat::NoObservables();
+
+	// generate the parameters for the whole batch, one parameter at a time
+	std::vector<double> batch_params;
+	double *all_params{ params_out };
+	if(all_params == nullptr)
+	{
+		batch_params.resize(num_params * n);
+		all_params = batch_params.data();
+	}
+	model->fillParametersBatch(engine, n, all_params);
+
+	// the workspace is reused for each trial in the batch
+	SimulationPlan::Workspace ws{ plan.makeWorkspace() };
+	double *params{ &ws.parameters()[0] };
+	std::size_t nproduced{ 0 };
+
+	for(std::size_t k = 0; k < n; ++k)
+	{
+		for(std::size_t i = 0; i < num_params; ++i)
+			params[i] = all_params[i * n + k];
+
+		produced[k] = plan.evaluate(ws, out + k, n);
+		if(produced[k])
+			++nproduced;
+	}
+
+	return nproduced;
+}
+
+std::size_t Simulator::numObservables() const noexcept
+{
+	return obs_functions.size();
+}
+
+std::size_t Simulator::numParameters() const noexcept
+{
+	return model->get_num_parameters();
+}
+
+std::vector<std::string> Simulator::parameterNames() const
+{
+	return model->getParameterNames();
 }
 
 void Simulator::setObservable(std::size_t j, const ObservableIndex &obs)
@@ -58,9 +119,18 @@ void Simulator::setObservable(std::size_t j, const ObservableIndex &obs)
 	ObservableFunction func { model->getObservableFunction(obs) };
 
 	if(j < length)
+	{
 		obs_functions[j] = func;
+		obs_indices[j] = obs;
+	}
 	else
+	{
 		obs_functions.push_back(func);
+		obs_indices.push_back(obs);
+	}
+
+	// recompile the plan
+	plan = SimulationPlan(*model, obs_indices);
 }
 
 } // namespace MolStat
@@ -18,6 +18,11 @@
  * function then simulates a random set of model parameters and calculates the
  * requested observables.
  *
+ * Rather than calling the molstat::ObservableFunction for each observable, the
+ * simulator compiles the model and observables into a
+ * molstat::SimulationPlan whenever an observable is set. The plan is used for
+ * all simulations.
+ *
  * Details for the molstat::SimulateModel class and molstat::Observable
  * template are found in the documentation of simulate_model.h.
  *
@@ -31,9 +36,11 @@
 #include <memory>
 #include <valarray>
 #include <vector>
+#include <string>
 #include <typeindex>
 #include <general/random_distributions/rng.h>
 #include "simulate_model.h"
+#include "simulation_plan.h"
 
 namespace molstat {
 
@@ -55,6 +62,16 @@ private:
 	 */
 	std::vector<ObservableFunction> obs_functions;
 
+	/// The observables (indices), in the same order as obs_functions.
+	std::vector<ObservableIndex> obs_indices;
+
+	/**
+	 * \brief The flattened plan for calculating the observables.
+	 *
+	 * This is recompiled whenever an observable is set.
+	 */
+	SimulationPlan plan;
+
 public:
 	Simulator() = delete;
 
@@ -73,15 +90,85 @@ public:
 	 * \brief Calculates the desired observables using the random number
 	 *    generator.
 	 *
+	 * This version is kept for compatibility; simulate(Engine &,
+	 * std::valarray<double> &) reports trials that do not produce an
+	 * observable without throwing.
+	 *
 	 * \throw molstat::NoObservables if no observables have been set.
-	 * \throw molstat::MissingDistribution if any of the model's required
-	 *    distributions is unspecified.
+	 * \throw molstat::NoObservableProduced if any of the observables is not
+	 *    produced by the simulated model parameters.
 	 *
 	 * \param[in] engine The C++11 random number engine.
 	 * \return The simulated observables.
 	 */
 	std::valarray<double> simulate(Engine &engine) const;
 
+	/**
+	 * \brief Calculates the desired observables using the random number
+	 *    generator, without throwing if an observable is not produced.
+	 *
+	 * \throw molstat::NoObservables if no observables have been set.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[out] obs The simulated observables (resized, if necessary).
+	 *    Observables that are not produced are NaN.
+	 * \return True if all observables were produced, false otherwise.
+	 */
+	bool simulate(Engine &engine, std::valarray<double> &obs) const;
+
+	/**
+	 * \brief Simulates a batch of trials, storing the observables in
+	 *    caller-provided, column-major buffers.
+	 *
+	 * Observable `j` of trial `k` is stored at `out[j*n + k]`; that is, each
+	 * observable has its own contiguous column of length `n`. Trials that do
+	 * not produce an observable (the observable function returns NaN) are
+	 * flagged with `false` in `produced`.
+	 *
+	 * The model parameters for the batch are generated with
+	 * SimulateModel::fillParametersBatch, one parameter at a time; the
+	 * random numbers are thus not the same as those of `n` successive calls
+	 * to simulate().
+	 *
+	 * If requested, the generated model parameters are also stored,
+	 * column-major: parameter `i` of trial `k` is stored at
+	 * `params[i*n + k]`.
+	 *
+	 * \throw molstat::NoObservables if no observables have been set.
+	 *
+	 * \param[in] engine The C++11 random number engine.
+	 * \param[in] n The number of trials to simulate.
+	 * \param[out] out Storage for numObservables() columns of `n` values.
+	 * \param[out] produced Storage for `n` flags; `true` if the trial produced
+	 *    all observables.
+	 * \param[out] params Storage for numParameters() columns of `n` values,
+	 *    or `nullptr` if the model parameters are not needed.
+	 * \return The number of trials that produced all observables.
+	 */
+	std::size_t simulateBatch(Engine &engine, std::size_t n, double *out,
+		bool *produced, double *params = nullptr) const;
+
+	/**
+	 * \brief Gets the number of observables that have been set.
+	 *
+	 * \return The number of observables.
+	 */
+	std::size_t numObservables() const noexcept;
+
+	/**
+	 * \brief Gets the number of model parameters generated for each trial.
+	 *
+	 * \return The number of model parameters.
+	 */
+	std::size_t numParameters() const noexcept;
+
+	/**
+	 * \brief Gets the names of the model parameters generated for each trial.
+	 *
+	 * \return The names, in the order of the parameters.
+	 */
+	std::vector<std::string> parameterNames() const;
+
 	/**
 	 * \brief Sets the `j`th observable for the simulator.
 	 *
@@ -91,5 +91,19 @@ int main(int argc, char **argv)
 	++iter;
 	assert(iter.at_end());
 
+	// the batch functions must agree with the single-value functions
+	const double x[] = { 1.e-5, 4.e-3, 7.e-2, 1.e+0 };
+	double u[4], d[4];
+	bstyle->mask(x, u, 4);
+	bstyle->dmaskdx(x, d, 4);
+	for(size_t k = 0; k < 4; ++k)
+	{
+		assert(u[k] == bstyle->mask(x[k]));
+		assert(d[k] == bstyle->dmaskdx(x[k]));
+	}
+	bstyle->invmask(u, u, 4);
+	for(size_t k = 0; k < 4; ++k)
+		assert(abs(u[k] - x[k]) < thresh * x[k]);
+
 	return 0;
 }
@@ -0,0 +1,120 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_batch.cc
+ * \brief Test suite for adding batches of data to histograms.
+ *
+ * \test Tests that adding batches of data (with a mask) to a
+ *    molstat::Histogram, including merging histograms and spanning several
+ *    internal storage chunks, produces the same bins as adding each data
+ *    element individually. Also tests that binning with several threads
+ *    produces the same bins.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <memory>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing batches of data in histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const vector<shared_ptr<const molstat::BinStyle>> bstyles{
+		make_shared<molstat::BinLinear>(7),
+		make_shared<molstat::BinLog>(9, 10.) };
+
+	// deterministic data, stored by dimension
+	constexpr size_t n = 50000;
+	vector<double> columns(2 * n);
+	unique_ptr<bool[]> mask{ new bool[n] };
+	for(size_t k = 0; k < n; ++k)
+	{
+		columns[k] = sin(0.37 * k);
+		columns[n + k] = exp(-5. * fabs(cos(0.11 * k)));
+		mask[k] = (k % 5 != 3);
+	}
+
+	// reference: add each element individually
+	molstat::Histogram ref(2);
+	for(size_t k = 0; k < n; ++k)
+	{
+		if(mask[k])
+			ref.add_data({ columns[k], columns[n + k] });
+	}
+	ref.bin_data(bstyles);
+
+	// add the data in two batches to two histograms, then merge them
+	molstat::Histogram hist(2), part(2);
+	const size_t half = n / 2;
+	hist.add_data(columns.data(), half, n, mask.get());
+	part.add_data(columns.data() + half, n - half, n, mask.get() + half);
+	hist.merge(part);
+
+	// the extremes should match
+	for(size_t j = 0; j < 2; ++j)
+	{
+		assert(hist.getExtremes(j)[0] == ref.getExtremes(j)[0]);
+		assert(hist.getExtremes(j)[1] == ref.getExtremes(j)[1]);
+	}
+
+	hist.bin_data(bstyles);
+
+	molstat::CounterIndex iter = hist.begin();
+	for(molstat::CounterIndex refiter = ref.begin(); !refiter.at_end();
+		++refiter, ++iter)
+	{
+		assert(!iter.at_end());
+		assert(hist.getBinCount(iter) == ref.getBinCount(refiter));
+	}
+	assert(iter.at_end());
+
+	// binning with several threads (more than there are chunks) gives the
+	// same bins
+	for(size_t nthreads = 2; nthreads <= 5; nthreads += 3)
+	{
+		molstat::Histogram threaded(2);
+		threaded.add_data(columns.data(), n, n, mask.get());
+		threaded.bin_data(bstyles, nthreads);
+
+		molstat::CounterIndex titer = threaded.begin();
+		for(molstat::CounterIndex refiter = ref.begin(); !refiter.at_end();
+			++refiter, ++titer)
+		{
+			assert(!titer.at_end());
+			assert(threaded.getBinCount(titer) == ref.getBinCount(refiter));
+		}
+		assert(titer.at_end());
+	}
+
+	// adding without a mask uses every element
+	molstat::Histogram all(2);
+	all.add_data(columns.data(), n, n);
+	all.bin_data(bstyles);
+
+	double total{ 0. };
+	for(molstat::CounterIndex ci = all.begin(); !ci.at_end(); ++ci)
+	{
+		const valarray<double> coords{ all.getCoordinates(ci) };
+		total += all.getBinCount(ci) / (bstyles[0]->dmaskdx(coords[0]) *
+			bstyles[1]->dmaskdx(coords[1]));
+	}
+	assert(abs(total - n) < 1.e-6 * n);
+
+	return 0;
+}
@@ -0,0 +1,243 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_serialize.cc
+ * \brief Test suite for writing, reading, and summing binned histograms.
+ *
+ * \test Tests that a molstat::Histogram written in the binary format is read
+ *    back exactly (dense, sparse, streaming, and non-streaming), and that
+ *    summing the histograms of two halves of the data gives the histogram of
+ *    all the data.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Writes a histogram in the binary format and reads it back.
+ *
+ * \param[in] hist The histogram.
+ * \return The histogram that was read.
+ */
+static unique_ptr<molstat::Histogram> roundTrip(const molstat::Histogram &hist)
+{
+	stringstream ss;
+	hist.serialize(ss);
+	return molstat::Histogram::deserialize(ss);
+}
+
+/**
+ * \brief Checks that two histograms have the same bins and counts.
+ *
+ * \throw std::exception if the test fails.
+ *
+ * \param[in] hist1 The first histogram.
+ * \param[in] hist2 The second histogram.
+ * \param[in] thresh The relative tolerance for the counts.
+ */
+static void compare(const molstat::Histogram &hist1,
+	const molstat::Histogram &hist2, const double thresh)
+{
+	assert(hist1.isStreaming() == hist2.isStreaming());
+	assert(hist1.isSparse() == hist2.isSparse());
+	assert(hist1.numOutside() == hist2.numOutside());
+
+	molstat::CounterIndex iter2 = hist2.begin();
+	for(molstat::CounterIndex iter1 = hist1.begin(); !iter1.at_end();
+		++iter1, ++iter2)
+	{
+		assert(!iter2.at_end());
+		assert(iter1.arrayOffset() == iter2.arrayOffset());
+
+		const valarray<double> coords1{ hist1.getCoordinates(iter1) },
+			coords2{ hist2.getCoordinates(iter2) };
+		for(size_t j = 0; j < coords1.size(); ++j)
+			assert(coords1[j] == coords2[j]);
+
+		const double count1{ hist1.getBinCount(iter1) },
+			count2{ hist2.getBinCount(iter2) };
+		assert(abs(count1 - count2) <= thresh * abs(count1));
+	}
+	assert(iter2.at_end());
+}
+
+/**
+ * \brief Main function for testing binary histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const vector<shared_ptr<const molstat::BinStyle>> bstyles{
+		make_shared<molstat::BinLinear>(7),
+		make_shared<molstat::BinLog>(9, 10.) };
+	const vector<array<double, 2>> ranges{ {{ -0.8, 0.8 }}, {{ 1.e-2, 1. }} };
+
+	// deterministic data, stored by dimension; some is outside the ranges
+	constexpr size_t n = 10000;
+	vector<double> columns(2 * n);
+	for(size_t k = 0; k < n; ++k)
+	{
+		columns[k] = sin(0.37 * k);
+		columns[n + k] = exp(-5. * fabs(cos(0.11 * k)));
+	}
+
+	// streaming histograms of all the data and of each half
+	molstat::Histogram all(bstyles, ranges), half1(bstyles, ranges),
+		half2(bstyles, ranges);
+	all.add_data(columns.data(), n, n);
+	half1.add_data(columns.data(), n / 2, n);
+	half2.add_data(columns.data() + n / 2, n - n / 2, n);
+	all.bin_data();
+	half1.bin_data();
+	half2.bin_data();
+	assert(all.numOutside() > 0);
+
+	// round trip
+	compare(all, *roundTrip(all), 0.);
+	for(size_t j = 0; j < 2; ++j)
+	{
+		const unique_ptr<molstat::Histogram> copy{ roundTrip(all) };
+		assert(copy->getExtremes(j) == all.getExtremes(j));
+		assert(copy->getUnderflow(j) == all.getUnderflow(j));
+		assert(copy->getOverflow(j) == all.getOverflow(j));
+	}
+
+	// sum the halves (after reading them back)
+	{
+		unique_ptr<molstat::Histogram> sum{ roundTrip(half1) };
+		sum->accumulate(*roundTrip(half2));
+		compare(all, *sum, 1.e-12);
+		for(size_t j = 0; j < 2; ++j)
+		{
+			assert(sum->getUnderflow(j) == all.getUnderflow(j));
+			assert(sum->getOverflow(j) == all.getOverflow(j));
+		}
+	}
+
+	// a non-streaming histogram
+	{
+		molstat::Histogram stored(2);
+		stored.add_data(columns.data(), n, n);
+		stored.bin_data(bstyles);
+		compare(stored, *roundTrip(stored), 0.);
+
+		// its bins are not the same as the streaming histogram's
+		try
+		{
+			unique_ptr<molstat::Histogram> copy{ roundTrip(stored) };
+			copy->accumulate(all);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// histograms with different ranges can't be summed
+	{
+		const vector<array<double, 2>> ranges2{ {{ -0.8, 0.9 }},
+			{{ 1.e-2, 1. }} };
+		molstat::Histogram other(bstyles, ranges2);
+		other.bin_data();
+
+		try
+		{
+			half1.accumulate(other);
+			assert(false);
+		}
+		catch(const invalid_argument &e)
+		{
+			// should be here
+		}
+	}
+
+	// a sparse histogram
+	{
+		const vector<shared_ptr<const molstat::BinStyle>> sstyles(3,
+			make_shared<molstat::BinLinear>(200));
+		const vector<array<double, 2>> sranges(3, {{ -1., 1. }});
+		molstat::Histogram sparse1(sstyles, sranges), sparse2(sstyles, sranges),
+			sparseall(sstyles, sranges);
+
+		vector<double> scolumns(3 * n);
+		for(size_t k = 0; k < n; ++k)
+		{
+			scolumns[k] = sin(0.37 * k);
+			scolumns[n + k] = cos(0.11 * k);
+			scolumns[2 * n + k] = sin(0.05 * k);
+		}
+		sparse1.add_data(scolumns.data(), n / 3, n);
+		sparse2.add_data(scolumns.data() + n / 3, n - n / 3, n);
+		sparseall.add_data(scolumns.data(), n, n);
+		sparse1.bin_data();
+		sparse2.bin_data();
+		sparseall.bin_data();
+		assert(sparseall.isSparse());
+
+		compare(sparseall, *roundTrip(sparseall), 0.);
+
+		unique_ptr<molstat::Histogram> sum{ roundTrip(sparse1) };
+		sum->accumulate(*roundTrip(sparse2));
+		compare(sparseall, *sum, 1.e-12);
+	}
+
+	// unbinned histograms can't be written
+	try
+	{
+		molstat::Histogram unbinned(2);
+		stringstream ss;
+		unbinned.serialize(ss);
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	// invalid files
+	try
+	{
+		stringstream ss("0.1 0.2 3\n0.3 0.4 5\n");
+		molstat::Histogram::deserialize(ss);
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	try
+	{
+		// truncated
+		stringstream ss;
+		all.serialize(ss);
+		const string full{ ss.str() };
+		stringstream truncated(full.substr(0, full.size() - 4));
+		molstat::Histogram::deserialize(truncated);
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_sparse.cc
+ * \brief Test suite for sparse histograms.
+ *
+ * \test Tests that a molstat::Histogram with many bins only stores (and
+ *    iterates over) its occupied bins, for both stored and streaming data,
+ *    and with several binning threads.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <memory>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+
+using namespace std;
+
+/**
+ * \brief Checks the occupied bins of a sparse histogram.
+ *
+ * \throw std::exception if the test fails.
+ *
+ * \param[in] hist The binned histogram.
+ */
+static void checkBins(const molstat::Histogram &hist);
+
+/**
+ * \brief Main function for testing sparse histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// 200^3 bins is too many to store
+	const vector<shared_ptr<const molstat::BinStyle>> bstyles(3,
+		make_shared<molstat::BinLinear>(200));
+	assert(200 * 200 * 200 > molstat::Histogram::max_dense_bins);
+
+	// the data is stored by dimension; with a range of [0, 200], each bin has
+	// width 1
+	const vector<vector<double>> points{
+		{ 0., 0., 0. },
+		{ 3.5, 7.5, 11.5 },
+		{ 150.5, 2.5, 99.5 },
+		{ 3.5, 7.5, 11.5 },
+		{ 200., 200., 200. },
+		{ 3.5, 7.5, 11.5 } };
+	const size_t n = points.size();
+	vector<double> columns(3 * n);
+	for(size_t k = 0; k < n; ++k)
+		for(size_t j = 0; j < 3; ++j)
+			columns[j * n + k] = points[k][j];
+
+	// stored data, binned with 1 or several threads
+	for(size_t nthreads = 1; nthreads <= 3; nthreads += 2)
+	{
+		molstat::Histogram hist(3);
+		hist.add_data(columns.data(), n, n);
+		hist.bin_data(bstyles, nthreads);
+
+		assert(hist.isSparse());
+		checkBins(hist);
+	}
+
+	// streaming data, split between two histograms (one element is outside
+	// the range)
+	{
+		const vector<array<double, 2>> ranges(3, {{ 0., 200. }});
+		molstat::Histogram hist(bstyles, ranges), part(bstyles, ranges);
+		assert(hist.isSparse());
+
+		hist.add_data(columns.data(), 3, n);
+		part.add_data(columns.data() + 3, n - 3, n);
+		part.add_data({ 10., 10., 250. });
+		hist.merge(part);
+		hist.bin_data();
+
+		assert(hist.numOutside() == 1);
+		checkBins(hist);
+	}
+
+	// few bins are stored
+	{
+		molstat::Histogram hist(3);
+		hist.add_data(columns.data(), n, n);
+		hist.bin_data({ make_shared<molstat::BinLinear>(20),
+			make_shared<molstat::BinLinear>(20),
+			make_shared<molstat::BinLinear>(20) });
+
+		assert(!hist.isSparse());
+	}
+
+	return 0;
+}
+
+static void checkBins(const molstat::Histogram &hist)
+{
+	// the occupied bins, in order of their offsets
+	const vector<vector<size_t>> bins{
+		{ 0, 0, 0 },
+		{ 3, 7, 11 },
+		{ 150, 2, 99 },
+		{ 199, 199, 199 } };
+	const vector<double> counts{ 1., 3., 1., 1. };
+
+	molstat::CounterIndex iter = hist.begin();
+	for(size_t b = 0; b < bins.size(); ++b, ++iter)
+	{
+		assert(!iter.at_end());
+		for(size_t j = 0; j < 3; ++j)
+			assert(iter[j] == bins[b][j]);
+
+		assert(hist.getBinCount(iter) == counts[b]);
+
+		const valarray<double> coords{ hist.getCoordinates(iter) };
+		for(size_t j = 0; j < 3; ++j)
+			assert(abs(coords[j] - (bins[b][j] + 0.5)) < 1.e-10);
+	}
+	assert(iter.at_end());
+
+	// an unoccupied bin has no count
+	molstat::CounterIndex empty({ 200, 200, 200 });
+	empty.setIndex(0, 5);
+	empty.setIndex(2, 11);
+	assert(hist.getBinCount(empty) == 0.);
+
+	// resetting goes back to the first occupied bin
+	iter.reset();
+	assert(!iter.at_end());
+	assert(iter.arrayOffset() == 0);
+	++iter;
+	assert(iter.arrayOffset() == 3 + 200 * (7 + 200 * 11));
+}
@@ -0,0 +1,143 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_streaming.cc
+ * \brief Test suite for streaming (fixed-range) histograms.
+ *
+ * \test Tests the molstat::Histogram class with a fixed range: data is binned
+ *    as it is added, data outside the range is counted as underflow or
+ *    overflow, and partial histograms can be merged.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing streaming histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const double thresh = 1.0e-6;
+	shared_ptr<const molstat::BinStyle> logstyle(
+		make_shared<molstat::BinLog>(5, 10.));
+	shared_ptr<const molstat::BinStyle> linstyle(
+		make_shared<molstat::BinLinear>(2));
+
+	// invalid ranges
+	try
+	{
+		molstat::Histogram bad({ logstyle }, {{{ 0., 1. }}});
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here; log(0) is not finite
+	}
+
+	try
+	{
+		molstat::Histogram bad({ linstyle }, {{{ 1., 1. }}});
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+		// should be here
+	}
+
+	// same data as histogram1d_log, using the range of that data
+	molstat::Histogram hist({ logstyle }, {{{ 1.e-5, 1. }}});
+	molstat::Histogram part(hist);
+	assert(hist.isStreaming());
+	assert(hist.getExtremes(0)[0] == 1.e-5 && hist.getExtremes(0)[1] == 1.);
+
+	hist.add_data({4.e-3}); // 3
+	hist.add_data({5.e-1}); // 5
+	hist.add_data({1.e-5}); // 1
+	hist.add_data({8.e-5}); // 1
+	hist.add_data({6.e-3}); // 3
+	hist.add_data({7.e-2}); // 4
+	part.add_data({4.e-3}); // 3
+	part.add_data({2.e-5}); // 1
+	part.add_data({1.e+0}); // 5
+	part.add_data({3.e-1}); // 5
+	part.add_data({4.e-3}); // 3
+	part.add_data({6.e-5}); // 1
+	part.add_data({1.e-2}); // 4
+
+	// outside the range
+	part.add_data({2.});
+	part.add_data({5.e-6});
+	part.add_data({-1.});
+	assert(part.numOutside() == 3);
+	assert(part.getUnderflow(0) == 2);
+	assert(part.getOverflow(0) == 1);
+
+	hist.merge(part);
+	assert(part.numOutside() == 0);
+	assert(hist.numOutside() == 3);
+	assert(hist.getUnderflow(0) == 2);
+	assert(hist.getOverflow(0) == 1);
+
+	// streaming histograms use their own binning styles
+	try
+	{
+		hist.bin_data({ logstyle });
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+		// should be here
+	}
+
+	hist.bin_data();
+
+	// the bins should match histogram1d_log
+	const double counts[5] = { 4., 0., 4., 2., 3. };
+	molstat::CounterIndex iter = hist.begin();
+	for(size_t j = 0; j < 5; ++j, ++iter)
+	{
+		const double coord = 5.5 * pow(10., -5. + j);
+		assert(abs(hist.getCoordinates(iter)[0] - coord) < thresh * coord);
+		assert(abs(hist.getBinCount(iter) - counts[j]*logstyle->dmaskdx(coord))
+			< thresh);
+	}
+	assert(iter.at_end());
+
+	// 2D: a point outside the range in either dimension is not binned
+	molstat::Histogram hist2({ linstyle, linstyle },
+		{{{ 0., 2. }}, {{ 0., 1. }}});
+	hist2.add_data({0.5, 0.5});
+	hist2.add_data({1.5, 0.25});
+	hist2.add_data({1.5, 3.});
+	hist2.add_data({-1., -1.});
+	assert(hist2.numOutside() == 2);
+	assert(hist2.getUnderflow(0) == 1 && hist2.getOverflow(0) == 0);
+	assert(hist2.getUnderflow(1) == 1 && hist2.getOverflow(1) == 1);
+	hist2.bin_data();
+
+	molstat::CounterIndex iter2 = hist2.begin();
+	assert(abs(hist2.getBinCount(iter2)) < thresh); // (0, 0)
+	++iter2;
+	assert(abs(hist2.getBinCount(iter2) - 1.) < thresh); // (1, 0)
+	++iter2;
+	assert(abs(hist2.getBinCount(iter2) - 1.) < thresh); // (0, 1)
+	++iter2;
+	assert(abs(hist2.getBinCount(iter2)) < thresh); // (1, 1)
+
+	return 0;
+}
@@ -0,0 +1,132 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file histogram_writer.cc
+ * \brief Test suite for writing histograms as text.
+ *
+ * \test Tests that molstat::HistogramWriter writes exactly the same text as
+ *    writing each bin with `std::ostream`, for dense and sparse histograms,
+ *    and that its exact format reproduces every number.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <general/histogram_tools/counterindex.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_writer.h>
+#include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/bin_log.h>
+
+using namespace std;
+
+/**
+ * \brief Writes a histogram by writing each bin with `std::ostream`.
+ *
+ * \param[in] hist The histogram.
+ * \return The text.
+ */
+static string streamHistogram(const molstat::Histogram &hist)
+{
+	ostringstream out;
+
+	for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+	{
+		const valarray<double> coords = hist.getCoordinates(ci);
+		for(size_t j = 0; j < coords.size(); ++j)
+			out << coords[j] << ' ';
+		out << hist.getBinCount(ci) << endl;
+	}
+
+	return out.str();
+}
+
+/**
+ * \brief Writes a histogram with molstat::HistogramWriter.
+ *
+ * \param[in] hist The histogram.
+ * \param[in] exact True for the exact format.
+ * \return The text.
+ */
+static string writeHistogram(const molstat::Histogram &hist, bool exact)
+{
+	ostringstream out;
+	molstat::HistogramWriter writer(out, exact);
+	writer.write(hist);
+
+	return out.str();
+}
+
+/**
+ * \brief Main function for testing the histogram writer.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	// deterministic data, stored by dimension
+	constexpr size_t n = 100000;
+	vector<double> columns(3 * n);
+	for(size_t k = 0; k < n; ++k)
+	{
+		columns[k] = 3. * sin(0.37 * k);
+		columns[n + k] = exp(-5. * fabs(cos(0.11 * k)));
+		columns[2 * n + k] = sin(0.05 * k);
+	}
+
+	// a dense histogram; the text is larger than the writer's buffer
+	{
+		molstat::Histogram hist(2);
+		hist.add_data(columns.data(), n, n);
+		hist.bin_data({ make_shared<molstat::BinLinear>(300),
+			make_shared<molstat::BinLog>(300, 10.) });
+		assert(!hist.isSparse());
+
+		const string text{ writeHistogram(hist, false) };
+		assert(text.size() > (1u << 20));
+		assert(text == streamHistogram(hist));
+
+		// the exact format reproduces the coordinates and counts
+		istringstream exact(writeHistogram(hist, true));
+		for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+		{
+			const valarray<double> coords = hist.getCoordinates(ci);
+			for(size_t j = 0; j < coords.size(); ++j)
+			{
+				string token;
+				exact >> token;
+				assert(strtod(token.c_str(), nullptr) == coords[j]);
+			}
+
+			string token;
+			exact >> token;
+			assert(strtod(token.c_str(), nullptr) == hist.getBinCount(ci));
+		}
+		string token;
+		assert(!(exact >> token));
+	}
+
+	// a sparse histogram
+	{
+		molstat::Histogram hist(3);
+		hist.add_data(columns.data(), n, n);
+		hist.bin_data({ make_shared<molstat::BinLinear>(200),
+			make_shared<molstat::BinLog>(200, 10.),
+			make_shared<molstat::BinLinear>(200) });
+		assert(hist.isSparse());
+
+		assert(writeHistogram(hist, false) == streamHistogram(hist));
+	}
+
+	return 0;
+}
@@ -0,0 +1,134 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file random_batch.cc
+ * \brief Test suite for the batch sampling of random distributions.
+ *
+ * \test Checks that molstat::Engine::generate reproduces the stream and that
+ *    the batch samples (molstat::RandomDistribution::sampleN) of each
+ *    distribution have the expected mean and variance.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <general/random_distributions/constant.h>
+#include <general/random_distributions/engine.h>
+#include <general/random_distributions/gamma.h>
+#include <general/random_distributions/lognormal.h>
+#include <general/random_distributions/normal.h>
+#include <general/random_distributions/uniform.h>
+#include <general/random_distributions/weibull.h>
+
+using namespace std;
+
+/**
+ * \brief Checks the mean and variance of batch samples.
+ *
+ * \param[in] dist The distribution.
+ * \param[in] mean The expected mean.
+ * \param[in] var The expected variance.
+ * \param[in] chunk The number of samples requested from each call to
+ *    sampleN.
+ */
+static void check_moments(const molstat::RandomDistribution &dist,
+	const double mean, const double var, const size_t chunk = 400001)
+{
+	// an odd number of samples, so that the partial blocks are used
+	constexpr size_t n = 400001;
+	vector<double> x(n);
+	molstat::Engine engine{ 2014 };
+	for(size_t start = 0; start < n; start += chunk)
+		dist.sampleN(engine, x.data() + start, min(chunk, n - start));
+
+	double m{ 0. }, v{ 0. };
+	for(double y : x)
+		m += y;
+	m /= n;
+	for(double y : x)
+		v += (y - m) * (y - m);
+	v /= n - 1;
+
+	// within several standard errors
+	assert(abs(m - mean) <= 6. * sqrt(var / n) + 1.e-12);
+	assert(abs(v - var) <= 0.05 * var + 1.e-12);
+}
+
+/**
+ * \brief Main function for testing the batch sampling.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	// generate should reproduce successive calls to the engine
+	{
+		constexpr size_t n = 37;
+		molstat::Engine e1{ 5 }, e2{ 5 };
+		vector<molstat::Engine::result_type> a(n), b(n);
+
+		e1();
+		e2();
+		for(size_t j = 0; j < n; ++j)
+			a[j] = e1();
+		e2.generate(b.data(), 10);
+		e2.generate(b.data() + 10, n - 10);
+		assert(a == b);
+		assert(e1() == e2());
+	}
+
+	// uniform numbers are in [0, 1)
+	{
+		constexpr size_t n = 1000;
+		vector<double> u(n);
+		molstat::Engine engine{ 1 };
+		molstat::uniformN(engine, u.data(), n);
+		for(double y : u)
+			assert(y >= 0. && y < 1.);
+	}
+
+	check_moments(molstat::ConstantDistribution(2.5), 2.5, 0.);
+	check_moments(molstat::UniformDistribution(-1., 3.), 1., 16. / 12.);
+	check_moments(molstat::NormalDistribution(2., 0.5), 2., 0.25);
+	check_moments(molstat::NormalDistribution(2., 0.5,
+		molstat::NormalMethod::BoxMuller), 2., 0.25);
+	check_moments(molstat::LognormalDistribution(0.1, 0.4),
+		exp(0.1 + 0.08), (exp(0.16) - 1.) * exp(0.2 + 0.16));
+	check_moments(molstat::LognormalDistribution(0.1, 0.4,
+		molstat::NormalMethod::BoxMuller),
+		exp(0.1 + 0.08), (exp(0.16) - 1.) * exp(0.2 + 0.16));
+	check_moments(molstat::GammaDistribution(3., 0.5), 1.5, 0.75);
+	check_moments(molstat::GammaDistribution(0.4, 2.), 0.8, 1.6);
+	check_moments(molstat::GammaDistribution(3., 0.5), 1.5, 0.75, 3);
+	check_moments(molstat::GammaDistribution(0.4, 2.), 0.8, 1.6, 1);
+	check_moments(molstat::WeibullDistribution(2., 1.),
+		sqrt(M_PI) / 2., 1. - M_PI / 4.);
+
+	// with the Box-Muller transform, single numbers are the same as blocks of
+	// one number
+	{
+		const molstat::NormalDistribution normal(2., 0.5,
+			molstat::NormalMethod::BoxMuller);
+		const molstat::LognormalDistribution lognormal(0.1, 0.4,
+			molstat::NormalMethod::BoxMuller);
+
+		molstat::Engine e1{ 3 }, e2{ 3 };
+		for(size_t k = 0; k < 100; ++k)
+		{
+			double x, y;
+			normal.sampleN(e1, &x, 1);
+			assert(normal.sample(e2) == x);
+			lognormal.sampleN(e1, &y, 1);
+			assert(lognormal.sample(e2) == y);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,209 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file random_empirical.cc
+ * \brief Test suite for the alias method and the empirical and mixture
+ *    distributions.
+ *
+ * \test Checks the frequencies of molstat::AliasTable, the moments of
+ *    molstat::EmpiricalDistribution and molstat::MixtureDistribution, and
+ *    the construction of these distributions from input tokens.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <general/random_distributions/alias_table.h>
+#include <general/random_distributions/empirical.h>
+#include <general/random_distributions/engine.h>
+#include <general/random_distributions/mixture.h>
+
+using namespace std;
+
+/**
+ * \brief Checks the mean and variance of single and batch samples.
+ *
+ * \param[in] dist The distribution.
+ * \param[in] mean The expected mean.
+ * \param[in] var The expected variance.
+ */
+static void check_moments(const molstat::RandomDistribution &dist,
+	const double mean, const double var)
+{
+	// an odd number of samples, so that the partial blocks are used
+	constexpr size_t n = 200001;
+	vector<double> x(n), y(n);
+	molstat::Engine engine{ 2014 };
+	dist.sampleN(engine, x.data(), n);
+	for(double &z : y)
+		z = dist.sample(engine);
+
+	for(const vector<double> &s : { x, y })
+	{
+		double m{ 0. }, v{ 0. };
+		for(double z : s)
+			m += z;
+		m /= n;
+		for(double z : s)
+			v += (z - m) * (z - m);
+		v /= n - 1;
+
+		// within several standard errors
+		assert(abs(m - mean) <= 6. * sqrt(var / n) + 1.e-12);
+		assert(abs(v - var) <= 0.05 * var + 1.e-12);
+	}
+}
+
+/**
+ * \brief Checks that constructing a distribution from tokens fails.
+ *
+ * \param[in] line The input line.
+ */
+static void check_invalid(const string &line)
+{
+	try
+	{
+		molstat::RandomDistributionFactory(molstat::tokenize(line));
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+	}
+}
+
+/**
+ * \brief Main function for testing the alias method.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	// the alias table reproduces the weights; with evenly spaced uniform
+	// numbers the frequencies are exact up to the spacing
+	{
+		const vector<double> weights{ 1., 0., 3., 6., 2. };
+		molstat::AliasTable table(weights);
+		assert(table.size() == weights.size());
+
+		constexpr size_t m = 120000;
+		vector<size_t> count(weights.size(), 0);
+		for(size_t k = 0; k < m; ++k)
+		{
+			double within;
+			const size_t j{ table.sample((k + 0.5) / m, within) };
+			assert(j < weights.size());
+			assert(within >= 0. && within < 1.);
+			++count[j];
+		}
+
+		for(size_t j = 0; j < weights.size(); ++j)
+			assert(abs(count[j] / double(m) - weights[j] / 12.) <= 1.e-4);
+
+		for(const vector<double> &bad : vector<vector<double>>{ {},
+			{ 0., 0. }, { 1., -1. }, { 1., NAN } })
+		{
+			try
+			{
+				molstat::AliasTable t(bad);
+				assert(false);
+			}
+			catch(const invalid_argument &e)
+			{
+			}
+		}
+	}
+
+	// histograms: constant density within each bin
+	const vector<double> centers{ 0., 1., 2., 3. }, weights{ 1., 2., 3., 4. };
+	check_moments(molstat::EmpiricalDistribution(centers, weights),
+		2., 1. + 1. / 12.);
+
+	// samples: each interval between sorted samples has the same weight
+	const vector<double> samples{ 4., 0., 2., 1. };
+	check_moments(molstat::EmpiricalDistribution(samples), 5. / 3., 11. / 9.);
+
+	// read the histogram from a file; sampling matches the direct construction
+	const string filename{ "random_empirical.dat" };
+	{
+		ofstream out(filename);
+		out << "# bin center, counts" << endl;
+		for(size_t j = 0; j < centers.size(); ++j)
+			out << centers[j] << ' ' << weights[j] << endl;
+	}
+	{
+		molstat::EmpiricalDistribution direct(centers, weights);
+		unique_ptr<molstat::RandomDistribution> file
+			{ molstat::RandomDistributionFactory(
+				molstat::tokenize("Empirical " + filename)) };
+
+		molstat::Engine e1{ 7 }, e2{ 7 };
+		vector<double> a(1000), b(1000);
+		direct.sampleN(e1, a.data(), a.size());
+		file->sampleN(e2, b.data(), b.size());
+		assert(a == b);
+		assert(direct.sample(e1) == file->sample(e2));
+	}
+
+	// a single column is a set of samples
+	{
+		ofstream out(filename);
+		out << "4\n0\n\n2\n1\n";
+	}
+	check_moments(molstat::EmpiricalDistribution(filename), 5. / 3., 11. / 9.);
+
+	// invalid files
+	for(const char *contents : { "", "1 2 3\n", "0 1\n1\n", "0 1\n1 x\n",
+		"1 1\n0 1\n", "0 1\n", "3\n3\n" })
+	{
+		{
+			ofstream out(filename);
+			out << contents;
+		}
+		check_invalid("empirical " + filename);
+	}
+	remove(filename.c_str());
+	check_invalid("empirical " + filename);
+	check_invalid("empirical");
+
+	// mixtures
+	{
+		unique_ptr<molstat::RandomDistribution> dist
+			{ molstat::RandomDistributionFactory(
+				molstat::tokenize("mixture 0.25 constant 1 0.75 uniform 0 2")) };
+		check_moments(*dist, 1., 0.25);
+
+		dist = molstat::RandomDistributionFactory(molstat::tokenize(
+			"Mixture 1 normal 0 1 boxmuller 3 Normal 4 1"));
+		check_moments(*dist, 3., 4.);
+
+		// the scratch storage is reused; repeated blocks are reproducible
+		vector<double> a(300), b(300);
+		molstat::Engine e1{ 11 }, e2{ 11 };
+		dist->sampleN(e1, a.data(), a.size());
+		dist->sampleN(e2, b.data(), b.size());
+		assert(a == b);
+		dist->sampleN(e1, a.data(), 5);
+		dist->sampleN(e2, b.data(), 5);
+		assert(a == b);
+	}
+
+	check_invalid("mixture");
+	check_invalid("mixture 1");
+	check_invalid("mixture constant 1");
+	check_invalid("mixture x constant 1");
+	check_invalid("mixture 1 constant");
+	check_invalid("mixture 1 mixture 1 constant 0");
+	check_invalid("mixture -1 constant 0 1 constant 1");
+	check_invalid("mixture 0 constant 0 0 constant 1");
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file random_engine.cc
+ * \brief Test suite for the random number engine.
+ *
+ * \test Test suite for the random number engine. Checks the Philox4x32-10
+ *    known-answer values (from the Random123 distribution) and the PCG64
+ *    values (from the PCG distribution), the xoshiro256 jumps (against
+ *    \f$x^{2^{128}}\f$ and \f$x^{2^{192}}\f$ modulo the characteristic
+ *    polynomial, found independently), and the substream, jump, and discard
+ *    functionality and the reproducibility of the substreams of each
+ *    generator.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+#include <general/random_distributions/engine.h>
+
+using namespace std;
+
+/**
+ * \brief Main function for testing the random number engine.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	using molstat::Engine;
+
+	// known-answer tests
+	{
+		const array<uint32_t, 4> r = Engine::philox({{0, 0, 0, 0}}, {{0, 0}});
+		assert(r[0] == 0x6627e8d5 && r[1] == 0xe169c58d &&
+			r[2] == 0xbc57ac4c && r[3] == 0x9b00dbd8);
+	}
+	{
+		const array<uint32_t, 4> r = Engine::philox(
+			{{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}},
+			{{0xffffffff, 0xffffffff}});
+		assert(r[0] == 0x408f276d && r[1] == 0x41c83b0e &&
+			r[2] == 0xa20bc7c6 && r[3] == 0x6d5451fd);
+	}
+	{
+		const array<uint32_t, 4> r = Engine::philox(
+			{{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}},
+			{{0xa4093822, 0x299f31d0}});
+		assert(r[0] == 0xd16cfe09 && r[1] == 0x94fdcceb &&
+			r[2] == 0x5001e420 && r[3] == 0x24126ea1);
+	}
+
+	// the first number of the stream should be the first block
+	{
+		Engine engine{ 0 };
+		assert(engine() == 0xe169c58d6627e8d5ull);
+		assert(engine() == 0x9b00dbd8bc57ac4cull);
+	}
+
+	// pcg64 with initial state 42 and sequence 54 (from the PCG demo)
+	{
+		Engine engine{ molstat::EngineType::PCG64, 42, 54 };
+		assert(engine() == 0x86b1da1d72062b68ull);
+		assert(engine() == 0x1304aa46c9853d39ull);
+		assert(engine() == 0xa3670e9e0dd50358ull);
+	}
+
+	// xoshiro256 jumps from the state {1, 2, 3, 4}
+	{
+		array<uint64_t, 4> s{{ 1, 2, 3, 4 }};
+		Engine::xoshiroJump(s);
+		assert(s[0] == 0x8c7a153956b5f3d1ull && s[1] == 0x701f1a713401d85eull &&
+			s[2] == 0x6527f66a65469085ull && s[3] == 0x8386b786c4408050ull);
+
+		s = {{ 1, 2, 3, 4 }};
+		Engine::xoshiroLongJump(s);
+		assert(s[0] == 0x096a8eb71295a400ull && s[1] == 0xdbf84991e50f4516ull &&
+			s[2] == 0x534ee745810d2a0eull && s[3] == 0x31655ca1a2215bf1ull);
+	}
+
+	// the generator names
+	for(molstat::EngineType type : { molstat::EngineType::Philox,
+		molstat::EngineType::MT19937_64, molstat::EngineType::Xoshiro256pp,
+		molstat::EngineType::PCG64 })
+	{
+		assert(molstat::engineTypeFromName(molstat::engineName(type)) == type);
+	}
+	try
+	{
+		molstat::engineTypeFromName("minstd");
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+	}
+
+	for(molstat::EngineType type : { molstat::EngineType::Philox,
+		molstat::EngineType::MT19937_64, molstat::EngineType::Xoshiro256pp,
+		molstat::EngineType::PCG64 })
+	{
+		// generate a reference stream
+		// long enough to span several buffers (of 256 numbers) of the engine
+		constexpr size_t n = 700;
+		vector<Engine::result_type> ref(n);
+		Engine engine{ type, 12345, 7 };
+		assert(engine.getType() == type);
+		for(size_t j = 0; j < n; ++j)
+			ref[j] = engine();
+
+		// the substream command should reproduce the stream, moving forward
+		// or backward
+		engine.substream(3);
+		assert(engine() != ref[0]);
+		engine.substream(7);
+		for(size_t j = 0; j < n; ++j)
+			assert(engine() == ref[j]);
+		engine.substream(9);
+		engine.substream(7);
+		assert(engine() == ref[0]);
+
+		// jumping moves to the next substream
+		{
+			Engine e{ type, 12345, 5 };
+			e();
+			e.jump();
+			e.jump();
+			assert(e() == ref[0]);
+		}
+
+		// generate should reproduce the stream, whether or not it starts at
+		// the beginning of the engine's buffer
+		{
+			vector<Engine::result_type> a(n - 1);
+			Engine e{ type, 12345, 7 };
+			e.generate(a.data(), 600);
+			e.generate(a.data() + 600, 10);
+			assert(equal(a.begin(), a.begin() + 610, ref.begin()));
+
+			Engine e2{ type, 12345, 7 };
+			e2();
+			e2.generate(a.data(), n - 1);
+			assert(equal(a.begin(), a.end(), ref.begin() + 1));
+		}
+
+		// each block of numbers depends only on its substream, not on the
+		// blocks drawn before it (as when blocks of trials are dealt out to
+		// threads)
+		{
+			constexpr size_t nblocks = 12, m = 1000;
+			vector<Engine::result_type> blocks(nblocks * m), check(m);
+			Engine e{ type, 2014 };
+			for(size_t b = 0; b < nblocks; ++b)
+			{
+				e.substream(b);
+				e.generate(blocks.data() + b * m, m);
+			}
+
+			for(size_t b : {nblocks - 1, size_t{ 4 }, size_t{ 0 }, size_t{ 7 }})
+			{
+				Engine e2{ type, 2014 };
+				e2.substream(b);
+				e2.generate(check.data(), m);
+				assert(equal(check.begin(), check.end(), blocks.begin() + b * m));
+			}
+		}
+
+		// different seeds should produce different streams
+		engine.seed(12346);
+		engine.substream(7);
+		assert(engine() != ref[0]);
+
+		// discard should be equivalent to drawing numbers
+		for(size_t skip : {0, 1, 5, 255, 256, 257, 300, 520})
+		{
+			for(size_t start : {0, 3, 256, 300})
+			{
+				if(start + skip >= n)
+					continue;
+
+				Engine e{ type, 12345, 7 };
+				for(size_t j = 0; j < start; ++j)
+					e();
+				e.discard(skip);
+				assert(e() == ref[start + skip]);
+			}
+		}
+	}
+
+	// the default generator is Philox
+	{
+		Engine e1{ 12345, 7 }, e2{ molstat::EngineType::Philox, 12345, 7 };
+		assert(e1() == e2());
+	}
+
+	return 0;
+}
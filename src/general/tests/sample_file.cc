@@ -0,0 +1,179 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file sample_file.cc
+ * \brief Test suite for writing and reading sample files.
+ *
+ * \test Tests that molstat::SampleWriter writes rows supplied out of order
+ *    (from several threads) and that molstat::SampleFile reads them back.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <general/histogram_tools/sample_file.h>
+
+using namespace std;
+
+/**
+ * \brief The value in a column of a row of the test table.
+ *
+ * \param[in] row The row.
+ * \param[in] j The column.
+ * \return The value.
+ */
+static double value(size_t row, size_t j)
+{
+	return sin(0.1 * row) + 10. * j;
+}
+
+/**
+ * \brief Main function for testing the sample files.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status: 0 if the code passes the test, non-zero otherwise.
+ */
+int main(int argc, char **argv)
+{
+	const string filename{ "sample_file.samples" };
+	const size_t nrows{ 1500 }, ncols{ 3 }, block{ 100 }, nthreads{ 4 };
+	const vector<string> names{ "obs0", "obs1", "param" + string(100, 'x') };
+
+	// the rows per group must keep the columns page-aligned
+	try
+	{
+		molstat::SampleWriter writer(filename, names, 2, nrows, 100);
+		assert(false);
+	}
+	catch(const invalid_argument &e)
+	{
+	}
+
+	// write the table in blocks, dealt out to several threads in reverse
+	{
+		molstat::SampleWriter writer(filename, names, 2, nrows, 512);
+
+		auto worker = [&] (size_t thread) -> void
+		{
+			vector<double> columns(ncols * block);
+			const size_t nblocks{ nrows / block };
+
+			for(size_t b = thread; b < nblocks; b += nthreads)
+			{
+				const size_t first{ (nblocks - 1 - b) * block };
+				for(size_t j = 0; j < ncols; ++j)
+					for(size_t k = 0; k < block; ++k)
+						columns[j * block + k] = value(first + k, j);
+
+				writer.write(first, block, columns.data(), block);
+			}
+		};
+
+		vector<thread> workers;
+		for(size_t t = 0; t < nthreads; ++t)
+			workers.emplace_back(worker, t);
+		for(auto &t : workers)
+			t.join();
+
+		// rows beyond the table
+		try
+		{
+			vector<double> columns(ncols);
+			writer.write(nrows, 1, columns.data(), 1);
+			assert(false);
+		}
+		catch(const out_of_range &e)
+		{
+		}
+
+		writer.close();
+	}
+
+	// read it back
+	{
+		molstat::SampleFile file(filename);
+
+		assert(file.numColumns() == ncols);
+		assert(file.numObservables() == 2);
+		assert(file.numRows() == nrows);
+		assert(file.rowsPerGroup() == 512);
+		assert(file.numGroups() == 3);
+		assert(file.groupRows(0) == 512);
+		assert(file.groupRows(2) == nrows - 2 * 512);
+
+		assert(file.columnName(0) == "obs0");
+		assert(file.columnName(1) == "obs1");
+		assert(file.columnName(2) == names[2].substr(0,
+			molstat::sample_name_length - 1));
+
+		for(size_t g = 0; g < file.numGroups(); ++g)
+		{
+			for(size_t j = 0; j < ncols; ++j)
+			{
+				const double *column{ file.column(g, j) };
+
+				// the columns of a group are contiguous
+				if(j > 0)
+					assert(column == file.column(g, j - 1) + file.rowsPerGroup());
+
+				for(size_t k = 0; k < file.groupRows(g); ++k)
+					assert(column[k] == value(g * 512 + k, j));
+
+				// the last group is padded
+				for(size_t k = file.groupRows(g); k < file.rowsPerGroup(); ++k)
+					assert(std::isnan(column[k]));
+			}
+		}
+
+		try
+		{
+			file.column(3, 0);
+			assert(false);
+		}
+		catch(const out_of_range &e)
+		{
+		}
+	}
+
+	// rows that are never supplied are NaN
+	{
+		molstat::SampleWriter writer(filename, { "obs" }, 1, 1000, 512);
+		const double x{ 1. };
+		writer.write(600, 1, &x, 1);
+	}
+	{
+		molstat::SampleFile file(filename);
+		assert(file.numGroups() == 2);
+		assert(std::isnan(file.column(0, 0)[0]));
+		assert(file.column(1, 0)[600 - 512] == 1.);
+		assert(std::isnan(file.column(1, 0)[0]));
+	}
+
+	// a file that is not a sample file
+	{
+		ofstream out(filename);
+		out << "This is not a sample file." << endl;
+	}
+	try
+	{
+		molstat::SampleFile file(filename);
+		assert(false);
+	}
+	catch(const runtime_error &e)
+	{
+	}
+
+	remove(filename.c_str());
+
+	return 0;
+}
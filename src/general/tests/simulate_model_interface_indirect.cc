@@ -15,6 +15,7 @@
  */
 
 #include <cassert>
+#include <cmath>
 #include "simulate_model_interface_observables.h"
 #include "simulate_model_interface_models.h"
 #include <general/random_distributions/rng.h>
@@ -78,7 +79,11 @@ int main(int argc, char **argv)
 		make_shared<molstat::ConstantDistribution>(distvalue));
 
 	// wrap the model into our simulator
-	molstat::Simulator sim( factory.getModel() );
+	shared_ptr<molstat::SimulateModel> model{ factory.getModel() };
+	molstat::Simulator sim( model );
+	const shared_ptr<BasicTestModel> basic =
+		dynamic_pointer_cast<BasicTestModel>(model);
+	assert(basic != nullptr);
 
 	// try to simulate data. this should fail because we haven't set any
 	// observables or distributions yet.
@@ -124,14 +129,17 @@ int main(int argc, char **argv)
 
 	valarray<double> data = sim.simulate(engine);
 	assert(abs(data[0] - distvalue) < 1.e-6);
+	assert(basic->nfused == 0);
 
 	// set another observable
 	sim.setObservable(1, observables.at("obs2"));
 
 	// verify the set of observables generated...
+	// both observables come from one call to the fused function
 	data = sim.simulate(engine);
 	assert(abs(data[0] - distvalue) < 1.e-6);
 	assert(abs(data[1] - BasicTestModel::obs2value) < 1.e-6);
+	assert(basic->nfused == 1);
 
 	// change an observable and recheck
 	sim.setObservable(0, observables.at("obs2"));
@@ -139,6 +147,46 @@ int main(int argc, char **argv)
 	assert(abs(data[0] - BasicTestModel::obs2value) < 1.e-6);
 	assert(abs(data[1] - BasicTestModel::obs2value) < 1.e-6);
 
+	// simulate a batch of trials; each observable has its own column
+	{
+		constexpr size_t n = 3;
+		double columns[2*n];
+		bool produced[n];
+
+		assert(sim.numObservables() == 2);
+		assert(sim.simulateBatch(engine, n, columns, produced) == n);
+		for(size_t k = 0; k < n; ++k)
+		{
+			assert(produced[k]);
+			assert(abs(columns[k] - BasicTestModel::obs2value) < 1.e-6);
+			assert(abs(columns[n + k] - BasicTestModel::obs2value) < 1.e-6);
+		}
+	}
+
+	// BasicObs5 doesn't produce an observable
+	sim.setObservable(1, molstat::GetObservableIndex<BasicObs5>());
+	try
+	{
+		sim.simulate(engine);
+		assert(false);
+	}
+	catch(const molstat::NoObservableProduced &e)
+	{
+		// should be here
+	}
+	assert(!sim.simulate(engine, data));
+	assert(abs(data[0] - BasicTestModel::obs2value) < 1.e-6);
+	assert(std::isnan(data[1]));
+	{
+		constexpr size_t n = 3;
+		double columns[2*n];
+		bool produced[n];
+
+		assert(sim.simulateBatch(engine, n, columns, produced) == 0);
+		for(size_t k = 0; k < n; ++k)
+			assert(!produced[k]);
+	}
+
 	// now load in Observable3
 	sim.setObservable(1, observables.at("obs3"));
 
@@ -22,7 +22,9 @@
 class BasicTestModel :
 	public BasicObs1,
 	public BasicObs2,
-	public BasicObs3
+	public BasicObs3,
+	public BasicObs5,
+	public molstat::FusedObservable<BasicTestModel, BasicObs1, BasicObs2>
 {
 public:
 	/// The set value for BasicObs2.
@@ -31,6 +33,14 @@ public:
 	/// Value to throw for BasicObs3.
 	constexpr static int obs3except = 4;
 
+	/// The number of times the fused function has been called.
+	mutable std::size_t nfused{ 0 };
+
+	/// Constructor that registers the fused function.
+	BasicTestModel() :
+		molstat::FusedObservable<BasicTestModel, BasicObs1, BasicObs2>(
+			&BasicTestModel::Obs12) {}
+
 	virtual double Obs1(const valarray<double> &params) const override
 	{
 		return params[0];
@@ -47,6 +57,21 @@ public:
 		return 0.;
 	}
 
+	virtual double Obs5(const valarray<double> &params) const override
+	{
+		// the old (throwing) way of not producing an observable
+		throw molstat::NoObservableProduced();
+		return 0.;
+	}
+
+	/// Calculates BasicObs1 and BasicObs2 together.
+	void Obs12(const valarray<double> &params, double *obs) const
+	{
+		++nfused;
+		obs[0] = Obs1(params);
+		obs[1] = Obs2(params);
+	}
+
 	virtual vector<string> get_names() const override
 	{
 		return { "a" };
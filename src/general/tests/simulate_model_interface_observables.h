@@ -101,4 +101,23 @@ public:
 	virtual double Obs4(const valarray<double> &vals) const = 0;
 };
 
+/// Dummy observable class.
+class BasicObs5 : public molstat::Observable<BasicObs5> {
+public:
+	BasicObs5() :
+		Observable(&BasicObs5::Obs5)
+	{
+	}
+
+	virtual ~BasicObs5() = default;
+
+	/**
+	 * \brief Dummy observable function for BasicObs5.
+	 *
+	 * \param[in] vals A set of model parameters.
+	 * \return The observable.
+	 */
+	virtual double Obs5(const valarray<double> &vals) const = 0;
+};
+
 #endif
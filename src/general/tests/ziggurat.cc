@@ -0,0 +1,98 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file ziggurat.cc
+ * \brief Test suite for the ziggurat generators.
+ *
+ * \test Checks the moments and the tail probabilities of the ziggurat normal
+ *    and exponential generators, both for single numbers and for blocks.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <general/random_distributions/engine.h>
+#include <general/random_distributions/ziggurat.h>
+
+using namespace std;
+
+/**
+ * \brief Checks the mean, variance, and a tail probability of samples.
+ *
+ * \param[in] x The samples.
+ * \param[in] mean The expected mean.
+ * \param[in] var The expected variance.
+ * \param[in] cut The start of the tail.
+ * \param[in] tail The expected probability that |x| > cut.
+ */
+static void check_samples(const vector<double> &x, const double mean,
+	const double var, const double cut, const double tail)
+{
+	const size_t n{ x.size() };
+	double m{ 0. }, v{ 0. }, t{ 0. };
+
+	for(double y : x)
+	{
+		m += y;
+		if(abs(y) > cut)
+			t += 1.;
+	}
+	m /= n;
+	for(double y : x)
+		v += (y - m) * (y - m);
+	v /= n - 1;
+	t /= n;
+
+	assert(abs(m - mean) <= 6. * sqrt(var / n));
+	assert(abs(v - var) <= 0.02 * var);
+	assert(abs(t - tail) <= 6. * sqrt(tail / n));
+}
+
+/**
+ * \brief Main function for testing the ziggurat generators.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	constexpr size_t n = 1000003;
+	vector<double> x(n);
+
+	// normal; the cut is past the start of the tail (about 3.65)
+	{
+		molstat::Engine engine{ 11 };
+		molstat::zigguratNormalN(engine, x.data(), n);
+		check_samples(x, 0., 1., 3.8, erfc(3.8 / sqrt(2.)));
+
+		// the odd moments vanish
+		double skew{ 0. };
+		for(double y : x)
+			skew += y * y * y;
+		assert(abs(skew / n) <= 6. * sqrt(15. / n));
+
+		// single numbers
+		for(size_t k = 0; k < n; ++k)
+			x[k] = molstat::zigguratNormal(engine);
+		check_samples(x, 0., 1., 3.8, erfc(3.8 / sqrt(2.)));
+	}
+
+	// exponential; the cut is past the start of the tail (about 7.70)
+	{
+		molstat::Engine engine{ 12 };
+		molstat::zigguratExponentialN(engine, x.data(), n);
+		for(double y : x)
+			assert(y >= 0.);
+		check_samples(x, 1., 1., 8., exp(-8.));
+
+		for(size_t k = 0; k < n; ++k)
+			x[k] = molstat::zigguratExponential(engine);
+		check_samples(x, 1., 1., 8., exp(-8.));
+	}
+
+	return 0;
+}
@@ -24,6 +24,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <list>
+#include <vector>
 #include <utility>
 #include <map>
 #include <string>
@@ -291,16 +292,25 @@ int main(int argc, char **argv)
 
 	// use the bin type to "unmask", if necessary, the data so that we fit in
 	// g, not some function of g
-	for(list<pair<array<double, 1>, double>>::iterator iter = data.begin();
-		iter != data.end(); ++iter)
+	// the independent variables are transformed as one column
 	{
+		vector<double> column(data.size());
+		auto iter = data.begin();
+		for(size_t k = 0; k < column.size(); ++k, ++iter)
+			column[k] = (*iter).first[0];
 
 		// transform the independent variable back to g
-		(*iter).first[0] = binstyle->invmask((*iter).first[0]);
+		binstyle->invmask(column.data(), column.data(), column.size());
+		iter = data.begin();
+		for(size_t k = 0; k < column.size(); ++k, ++iter)
+			(*iter).first[0] = column[k];
 
 		// transform the PDF: P_g(g)
 		//    = P_mask(g)(mask(g)) * dmaskdx(invmask(u))
-		(*iter).second *= binstyle->dmaskdx((*iter).first[0]);
+		binstyle->dmaskdx(column.data(), column.data(), column.size());
+		iter = data.begin();
+		for(size_t k = 0; k < column.size(); ++k, ++iter)
+			(*iter).second *= column[k];
 	}
 
 	// do we need to load the default guesses?
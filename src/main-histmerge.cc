@@ -0,0 +1,144 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file main-histmerge.cc
+ * \brief Main function for summing binary histograms.
+ *
+ * Histograms from independent simulations (e.g., jobs that each simulate some
+ * of the trials) are written by `molstat-simulator` in the binary format
+ * (`format binary`). This program sums histograms with the same bins and
+ * writes the result, either in the binary format or as text (the same text
+ * format as `molstat-simulator`).
+ *
+ * Usage:
+ * \verbatim
+ molstat-histmerge [-t | -e] output input1 [input2 ...]
+ \endverbatim
+ * where `-t` requests text output and `-e` requests exact text output (all
+ * the digits needed to reproduce each number).
+ */
+
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_writer.h>
+
+using namespace std;
+
+/**
+ * \brief Reads a binary histogram from a file.
+ *
+ * \throw std::runtime_error if the file cannot be opened or does not contain
+ *    a histogram.
+ *
+ * \param[in] filename The name of the file.
+ * \return The histogram.
+ */
+static unique_ptr<molstat::Histogram> readHistogram(const string &filename)
+{
+	ifstream in(filename, ios_base::binary);
+	if(!in)
+		throw runtime_error("Unable to open \"" + filename + "\".");
+
+	try
+	{
+		return molstat::Histogram::deserialize(in);
+	}
+	catch(const runtime_error &e)
+	{
+		throw runtime_error("\"" + filename + "\": " + e.what());
+	}
+}
+
+/**
+ * \brief Main function for summing histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	// process the command-line arguments
+	int arg{ 1 };
+	bool text{ false }, exact{ false };
+	if(arg < argc && (strcmp(argv[arg], "-t") == 0 ||
+		strcmp(argv[arg], "-e") == 0))
+	{
+		text = true;
+		exact = (strcmp(argv[arg], "-e") == 0);
+		++arg;
+	}
+
+	if(argc - arg < 2)
+	{
+		cout << "Usage: " << argv[0] << " [-t | -e] output input1 " \
+			"[input2 ...]\n   Sums the binary histograms in the input files " \
+			"and writes the result\n   to the output file (as text with -t, " \
+			"or exact text with -e)." << endl;
+		return 0;
+	}
+
+	const string outname{ argv[arg++] };
+
+	// read and sum the histograms
+	unique_ptr<molstat::Histogram> hist{ nullptr };
+	try
+	{
+		hist = readHistogram(argv[arg++]);
+
+		for(; arg < argc; ++arg)
+		{
+			const unique_ptr<molstat::Histogram> other{ readHistogram(argv[arg]) };
+
+			try
+			{
+				hist->accumulate(*other);
+			}
+			catch(const invalid_argument &e)
+			{
+				throw runtime_error("\"" + string(argv[arg]) + "\": " + e.what());
+			}
+		}
+	}
+	catch(const exception &e)
+	{
+		cout << "FATAL ERROR: " << e.what() << endl;
+		return 0;
+	}
+
+	// write the sum
+	ofstream out(outname, text ? ios_base::trunc :
+		ios_base::binary | ios_base::trunc);
+	if(!out)
+	{
+		cout << "FATAL ERROR: Unable to open \"" << outname << "\" for output." <<
+			endl;
+		return 0;
+	}
+
+	try
+	{
+		if(text)
+		{
+			molstat::HistogramWriter writer(out, exact);
+			writer.write(*hist);
+		}
+		else
+			hist->serialize(out);
+	}
+	catch(const exception &e)
+	{
+		cout << "FATAL ERROR: " << e.what() << endl;
+	}
+
+	return 0;
+}
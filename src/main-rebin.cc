@@ -0,0 +1,372 @@
+/* This file is a part of MolStat, which is distributed under the Creative
+   Commons Attribution-NonCommercial 4.0 International Public License.
+
+   (c) 2014 Northwestern University. */
+
+/**
+ * \file main-rebin.cc
+ * \brief Main function for binning stored samples into histograms.
+ *
+ * `molstat-simulator` can write the raw samples of a simulation to a sample
+ * file (see molstat::SampleWriter). This program reads an input deck from
+ * standard in that names a sample file and describes several histograms,
+ * each with its own columns (observables or model parameters), binning
+ * styles, and ranges. The histograms are then made with one pass through the
+ * sample file (two if some histogram does not specify ranges); see
+ * molstat::binSamples.
+ *
+ * The input deck has the commands
+ * \verbatim
+ samples filename
+ threads n
+ histogram filename [text | exact | binary]
+    column name nbin binstyle [range min max]
+    ...
+ endhistogram
+ \endverbatim
+ * where each histogram has one `column` line per dimension.
+ */
+
+#include <array>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <general/string_tools.h>
+#include <general/histogram_tools/bin_style.h>
+#include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_writer.h>
+#include <general/histogram_tools/sample_binning.h>
+#include <general/histogram_tools/sample_file.h>
+
+using namespace std;
+
+/// A column of a histogram, as specified in the input deck.
+struct ColumnInformation
+{
+	/// The name of the column.
+	string name;
+
+	/// The binning style.
+	shared_ptr<const molstat::BinStyle> style;
+
+	/// True if a range was specified.
+	bool haverange;
+
+	/// The range, if specified.
+	array<double, 2> range;
+};
+
+/// A histogram, as specified in the input deck.
+struct HistogramInformation
+{
+	/// The output file.
+	string filename;
+
+	/// The output format: text, exact, or binary.
+	string format;
+
+	/// The columns.
+	vector<ColumnInformation> columns;
+};
+
+/**
+ * \brief Prints an error message.
+ *
+ * \param[in] lineno The line number.
+ * \param[in] message The error message.
+ */
+static void printError(size_t lineno, const string &message)
+{
+	cout << "Error on line " << setw(2) << lineno << ": " << message << endl;
+}
+
+/**
+ * \brief Reads a column of a histogram.
+ *
+ * \throw std::invalid_argument if the column cannot be read.
+ *
+ * \param[in] tokens The tokens after the `column` command.
+ * \return The column.
+ */
+static ColumnInformation readColumn(molstat::TokenContainer tokens)
+{
+	if(tokens.size() < 3)
+		throw invalid_argument("No column, number of bins, and/or binning " \
+			"style specified.");
+
+	ColumnInformation ret;
+	ret.name = tokens.front();
+	tokens.pop();
+
+	// an optional range ("range min max") follows the binning style
+	molstat::TokenContainer styletokens, rangetokens;
+	ret.haverange = false;
+	while(!tokens.empty())
+	{
+		if(!ret.haverange && molstat::to_lower(tokens.front()) == "range")
+			ret.haverange = true;
+		else if(ret.haverange)
+			rangetokens.push(tokens.front());
+		else
+			styletokens.push(tokens.front());
+		tokens.pop();
+	}
+
+	if(ret.haverange)
+	{
+		if(rangetokens.size() != 2)
+			throw invalid_argument("A range requires a minimum and maximum value.");
+
+		try
+		{
+			ret.range[0] = molstat::cast_string<double>(rangetokens.front());
+			rangetokens.pop();
+			ret.range[1] = molstat::cast_string<double>(rangetokens.front());
+		}
+		catch(const bad_cast &e)
+		{
+			throw invalid_argument(
+				"Unable to convert the range to numerical values.");
+		}
+
+		if(!(ret.range[0] < ret.range[1]))
+			throw invalid_argument(
+				"The minimum of the range must be less than the maximum.");
+	}
+
+	ret.style = molstat::BinStyleFactory(move(styletokens));
+
+	return ret;
+}
+
+/**
+ * \brief Main function for binning samples into histograms.
+ *
+ * \param[in] argc The number of command-line arguments.
+ * \param[in] argv The command-line arguments.
+ * \return Exit status; 0 for normal.
+ */
+int main(int argc, char **argv)
+{
+	string samplefilename;
+	size_t nthreads{ 1 };
+	vector<HistogramInformation> hists;
+	bool errors{ false };
+
+	// read the input deck
+	{
+		size_t lineno{ 0 };
+		bool inhist{ false };
+
+		for(string line; getline(cin, line);)
+		{
+			++lineno;
+
+			molstat::TokenContainer tokens = molstat::tokenize(line);
+			if(tokens.size() == 0) // empty line
+				continue;
+
+			const string command{ molstat::to_lower(tokens.front()) };
+			tokens.pop();
+
+			if(inhist && command == "column")
+			{
+				try
+				{
+					hists.back().columns.emplace_back(readColumn(move(tokens)));
+				}
+				catch(const invalid_argument &e)
+				{
+					printError(lineno, molstat::find_replace(e.what(), "\n",
+						"\n   "));
+					errors = true;
+				}
+			}
+			else if(inhist && command == "endhistogram")
+			{
+				if(hists.back().columns.size() == 0)
+				{
+					printError(lineno, "The histogram has no columns.");
+					errors = true;
+				}
+				inhist = false;
+			}
+			else if(inhist)
+			{
+				printError(lineno, "Unknown histogram command: \"" + command +
+					"\".");
+				errors = true;
+			}
+			else if(command == "histogram")
+			{
+				HistogramInformation hist;
+				hist.format = "text";
+				inhist = true;
+
+				if(tokens.size() == 0)
+				{
+					printError(lineno, "No output file name specified.");
+					errors = true;
+				}
+				else
+				{
+					hist.filename = tokens.front();
+					tokens.pop();
+
+					if(tokens.size() > 0)
+					{
+						hist.format = molstat::to_lower(tokens.front());
+						if(hist.format != "text" && hist.format != "exact" &&
+							hist.format != "binary")
+						{
+							printError(lineno, "Unknown output format \"" +
+								tokens.front() + "\". Options are text, exact, and " \
+								"binary.");
+							errors = true;
+						}
+					}
+				}
+
+				hists.emplace_back(move(hist));
+			}
+			else if(command == "samples")
+			{
+				if(tokens.size() == 0)
+				{
+					printError(lineno, "No sample file name specified.");
+					errors = true;
+				}
+				else
+					samplefilename = tokens.front();
+			}
+			else if(command == "threads")
+			{
+				if(tokens.size() == 0)
+				{
+					printError(lineno, "Number of threads not specified.");
+					errors = true;
+					continue;
+				}
+
+				try
+				{
+					nthreads = molstat::cast_string<size_t>(tokens.front());
+					if(nthreads == 0)
+					{
+						printError(lineno, "At least 1 thread should be specified.");
+						nthreads = 1;
+						errors = true;
+					}
+				}
+				catch(const bad_cast &e)
+				{
+					printError(lineno, "Unable to convert \"" + tokens.front() +
+						"\" to a non-negative number.");
+					errors = true;
+				}
+			}
+			else
+			{
+				printError(lineno, "Unknown command: \"" + command + "\".");
+				errors = true;
+			}
+		}
+
+		if(inhist)
+		{
+			cout << "FATAL ERROR: Missing \"endhistogram\" command." << endl;
+			return 0;
+		}
+	}
+
+	if(errors)
+	{
+		cout << "FATAL ERROR: Errors in the input deck." << endl;
+		return 0;
+	}
+	if(samplefilename.size() == 0)
+	{
+		cout << "FATAL ERROR: No sample file specified." << endl;
+		return 0;
+	}
+	if(hists.size() == 0)
+	{
+		cout << "FATAL ERROR: No histograms specified." << endl;
+		return 0;
+	}
+
+	try
+	{
+		const molstat::SampleFile file(samplefilename);
+
+		cout << "Sample file " << samplefilename << ": " << file.numRows() <<
+			" trials, " << file.numColumns() << " columns.\n";
+
+		// set up the histograms
+		vector<molstat::SampleHistogramSpec> specs(hists.size());
+		for(size_t h = 0; h < hists.size(); ++h)
+		{
+			for(const ColumnInformation &column : hists[h].columns)
+			{
+				try
+				{
+					specs[h].columns.push_back(file.findColumn(column.name));
+				}
+				catch(const out_of_range &e)
+				{
+					throw runtime_error("The sample file has no column named \"" +
+						column.name + "\".");
+				}
+				specs[h].styles.push_back(column.style);
+
+				if(column.haverange)
+					specs[h].ranges.push_back(column.range);
+			}
+
+			if(specs[h].ranges.size() != 0 &&
+				specs[h].ranges.size() != specs[h].columns.size())
+			{
+				throw runtime_error("Histogram " + hists[h].filename + ": a range " \
+					"must be specified for every column or for none of them.");
+			}
+		}
+
+		// make and write the histograms
+		const vector<unique_ptr<molstat::Histogram>> results{
+			molstat::binSamples(file, specs, nthreads) };
+
+		for(size_t h = 0; h < hists.size(); ++h)
+		{
+			const bool binary{ hists[h].format == "binary" };
+			ofstream out(hists[h].filename, binary ?
+				ios_base::binary | ios_base::trunc : ios_base::trunc);
+			if(!out)
+				throw runtime_error("Unable to open \"" + hists[h].filename +
+					"\" for output.");
+
+			if(binary)
+				results[h]->serialize(out);
+			else
+			{
+				molstat::HistogramWriter writer(out, hists[h].format == "exact");
+				writer.write(*results[h]);
+			}
+
+			cout << "Histogram " << hists[h].filename << ": " <<
+				results[h]->numOutside() << " trials outside the range.\n";
+		}
+	}
+	catch(const exception &e)
+	{
+		cout << "FATAL ERROR: " << e.what() << endl;
+		return 0;
+	}
+
+	return 0;
+}
@@ -190,7 +190,8 @@ void SimulatorInputParse::readInput(std::istream &input, std::ostream &output)
 			}
 		}
 		else if(command == "observable" || command == "observable_x" ||
-			command == "observable_y")
+			command == "observable_y" || command == "observable_z" ||
+			command == "observable_w")
 		{
 			// make sure we have a name for the observable, the number of bins,
 			// and (at least) the name of the binning style
@@ -205,17 +206,65 @@ void SimulatorInputParse::readInput(std::istream &input, std::ostream &output)
 				string obsname = molstat::to_lower(tokens.front());
 				tokens.pop();
 
+				// an optional range ("range min max") follows the binning
+				// style. separate these tokens from the binning style tokens
+				molstat::TokenContainer styletokens, rangetokens;
+				bool haverange{ false };
+				while(!tokens.empty())
+				{
+					if(!haverange && molstat::to_lower(tokens.front()) == "range")
+						haverange = true;
+					else if(haverange)
+						rangetokens.push(tokens.front());
+					else
+						styletokens.push(tokens.front());
+					tokens.pop();
+				}
+
 				// construct the binning style
 				try
 				{
+					array<double, 2> range;
+					if(haverange)
+					{
+						if(rangetokens.size() != 2)
+							throw invalid_argument(
+								"A range requires a minimum and maximum value.");
+
+						try
+						{
+							range[0] = molstat::cast_string<double>(
+								rangetokens.front());
+							rangetokens.pop();
+							range[1] = molstat::cast_string<double>(
+								rangetokens.front());
+						}
+						catch(const bad_cast &e)
+						{
+							throw invalid_argument(
+								"Unable to convert the range to numerical values.");
+						}
+
+						if(!(range[0] < range[1]))
+							throw invalid_argument(
+								"The minimum of the range must be less than the " \
+								"maximum.");
+					}
+
 					shared_ptr<molstat::BinStyle> binstyle
-						{ molstat::BinStyleFactory(move(tokens)) };
+						{ molstat::BinStyleFactory(move(styletokens)) };
 
 					// store the observable name and binning style
+					size_t axis{ 0 };
 					if(command == "observable_y")
-						obs_bins.emplace(1, make_pair(obsname, binstyle));
-					else
-						obs_bins.emplace(0, make_pair(obsname, binstyle));
+						axis = 1;
+					else if(command == "observable_z")
+						axis = 2;
+					else if(command == "observable_w")
+						axis = 3;
+					obs_bins.emplace(axis, make_pair(obsname, binstyle));
+					if(haverange)
+						obs_ranges.emplace(axis, range);
 				}
 				catch(const invalid_argument &e)
 				{
@@ -236,6 +285,29 @@ void SimulatorInputParse::readInput(std::istream &input, std::ostream &output)
 				histfilename = tokens.front();
 			}
 		}
+		else if(command == "samples")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No sample file name specified.");
+			}
+			else
+			{
+				samplefilename = tokens.front();
+				tokens.pop();
+
+				// the model parameters are optional
+				sample_parameters = false;
+				if(tokens.size() > 0)
+				{
+					if(molstat::to_lower(tokens.front()) == "parameters")
+						sample_parameters = true;
+					else
+						printError(output, lineno, "Unknown sample option \"" +
+							tokens.front() + "\". The only option is parameters.");
+				}
+			}
+		}
 		else if(command == "trials")
 		{
 			if(tokens.size() == 0)
@@ -258,6 +330,157 @@ void SimulatorInputParse::readInput(std::istream &input, std::ostream &output)
 				}
 			}
 		}
+		else if(command == "threads")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "Number of threads not specified.");
+			}
+			else
+			{
+				try
+				{
+					const size_t n = molstat::cast_string<size_t>(tokens.front());
+					if(n == 0)
+						printError(output, lineno,
+							"At least 1 thread should be specified.");
+					else
+						nthreads = n;
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" + tokens.front() +
+						"\" to a non-negative number.");
+				}
+			}
+		}
+		else if(command == "format")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No output format specified.");
+			}
+			else
+			{
+				const string format{ molstat::to_lower(tokens.front()) };
+
+				if(format == "text" || format == "exact")
+				{
+					binary_output = false;
+					exact_output = (format == "exact");
+				}
+				else if(format == "binary")
+					binary_output = true;
+				else
+					printError(output, lineno, "Unknown output format \"" +
+						tokens.front() + "\". Options are text, exact, and binary.");
+			}
+		}
+		else if(command == "pilot")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "Number of pilot trials not specified.");
+			}
+			else
+			{
+				try
+				{
+					const size_t n = molstat::cast_string<size_t>(tokens.front());
+					tokens.pop();
+
+					// the safety margin is optional
+					double margin{ pilot_margin };
+					if(tokens.size() > 0)
+						margin = molstat::cast_string<double>(tokens.front());
+
+					if(n == 0)
+						printError(output, lineno,
+							"At least 1 pilot trial should be specified.");
+					else if(!(margin >= 0.))
+						printError(output, lineno,
+							"The pilot safety margin must be non-negative.");
+					else
+					{
+						npilot = n;
+						pilot_margin = margin;
+					}
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert the number of " \
+						"pilot trials and/or the safety margin to numbers.");
+				}
+			}
+		}
+		else if(command == "seed")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No seed specified.");
+			}
+			else
+			{
+				try
+				{
+					rngseed = molstat::cast_string<size_t>(tokens.front());
+				}
+				catch(const bad_cast &e)
+				{
+					printError(output, lineno, "Unable to convert \"" + tokens.front() +
+						"\" to a non-negative number.");
+				}
+			}
+		}
+		else if(command == "stream")
+		{
+			// stream K of N
+			try
+			{
+				if(tokens.size() != 3)
+					throw bad_cast();
+
+				const size_t k{ molstat::cast_string<size_t>(tokens.front()) };
+				tokens.pop();
+				if(molstat::to_lower(tokens.front()) != "of")
+					throw bad_cast();
+				tokens.pop();
+				const size_t n{ molstat::cast_string<size_t>(tokens.front()) };
+
+				if(k < 1 || k > n)
+					printError(output, lineno, "The stream must be from 1 to the " \
+						"number of streams.");
+				else
+				{
+					stream_index = k;
+					nstreams = n;
+				}
+			}
+			catch(const bad_cast &e)
+			{
+				printError(output, lineno, "Use \"stream K of N\", where K and N " \
+					"are positive integers.");
+			}
+		}
+		else if(command == "engine")
+		{
+			if(tokens.size() == 0)
+			{
+				printError(output, lineno, "No random number engine specified.");
+			}
+			else
+			{
+				try
+				{
+					rngtype = molstat::engineTypeFromName(
+						molstat::to_lower(tokens.front()));
+				}
+				catch(const invalid_argument &e)
+				{
+					printError(output, lineno, e.what());
+				}
+			}
+		}
 		else
 		{
 			printError(output, lineno, "Unknown command: \"" + command + "\".");
@@ -442,6 +665,61 @@ std::size_t SimulatorInputParse::numTrials() const noexcept
 	return trials;
 }
 
+std::size_t SimulatorInputParse::numThreads() const noexcept
+{
+	return nthreads;
+}
+
+std::uint64_t SimulatorInputParse::seed() const noexcept
+{
+	return rngseed;
+}
+
+molstat::EngineType SimulatorInputParse::engineType() const noexcept
+{
+	return rngtype;
+}
+
+std::size_t SimulatorInputParse::numStreams() const noexcept
+{
+	return nstreams;
+}
+
+std::size_t SimulatorInputParse::streamIndex() const noexcept
+{
+	return stream_index;
+}
+
+std::size_t SimulatorInputParse::pilotTrials() const noexcept
+{
+	return npilot;
+}
+
+bool SimulatorInputParse::binaryOutput() const noexcept
+{
+	return binary_output;
+}
+
+bool SimulatorInputParse::exactOutput() const noexcept
+{
+	return exact_output;
+}
+
+double SimulatorInputParse::pilotMargin() const noexcept
+{
+	return pilot_margin;
+}
+
+std::string SimulatorInputParse::sampleFileName() const
+{
+	return samplefilename;
+}
+
+bool SimulatorInputParse::sampleParameters() const noexcept
+{
+	return sample_parameters;
+}
+
 std::string SimulatorInputParse::ModelInformation::to_string() const
 {
 	// first put in the name
@@ -481,7 +759,14 @@ void SimulatorInputParse::printState(std::ostream &output) const
 			for(auto obs_bin : obs_bins)
 			{
 				output << obs_bin.first << " -> " << obs_bin.second.first <<
-					" (" << obs_bin.second.second->info() << ")\n";
+					" (" << obs_bin.second.second->info();
+
+				const auto range = obs_ranges.find(obs_bin.first);
+				if(range != obs_ranges.end())
+					output << ", range [" << range->second[0] << ", " <<
+						range->second[1] << "]";
+
+				output << ")\n";
 			}
 		}
 		else
@@ -492,9 +777,39 @@ void SimulatorInputParse::printState(std::ostream &output) const
 	output << trials << " data point";
 	if(trials != 1)
 		output << 's';
-	output << " will be simulated.\n";
+	output << " will be simulated using " << nthreads << " thread";
+	if(nthreads != 1)
+		output << 's';
+	output << ".\n";
+
+	if(npilot > 0)
+	{
+		output << "A pilot run of " << npilot << " trial";
+		if(npilot != 1)
+			output << 's';
+		output << " will determine the histogram range (safety margin " <<
+			pilot_margin << ").\n";
+	}
+
+	output << "Random Number Seed: " << rngseed << '\n';
+	output << "Random Number Engine: " << molstat::engineName(rngtype) << '\n';
+	if(nstreams > 1)
+		output << "Stream: " << stream_index << " of " << nstreams << '\n';
+
+	output << "Histogram Output File: " << histfilename;
+	if(binary_output)
+		output << " (binary)";
+	else if(exact_output)
+		output << " (exact text)";
+	output << '\n';
 
-	output << "Histogram Output File: " << histfilename << '\n';
+	if(samplefilename.size() > 0)
+	{
+		output << "Sample Output File: " << samplefilename;
+		if(sample_parameters)
+			output << " (with model parameters)";
+		output << '\n';
+	}
 }
 
 std::string SimulatorInputParse::outputFileName() const
@@ -502,6 +817,18 @@ std::string SimulatorInputParse::outputFileName() const
 	return histfilename;
 }
 
+std::vector<std::string> SimulatorInputParse::getObservableNames() const
+{
+	vector<string> ret(obs_bins.size());
+
+	for(auto obs_bin : obs_bins)
+	{
+		ret[obs_bin.first] = obs_bin.second.first;
+	}
+
+	return ret;
+}
+
 std::vector<std::shared_ptr<molstat::BinStyle>>
 	SimulatorInputParse::getBinStyles() const
 {
@@ -514,3 +841,24 @@ std::vector<std::shared_ptr<molstat::BinStyle>>
 
 	return ret;
 }
+
+std::vector<std::array<double, 2>> SimulatorInputParse::getRanges() const
+{
+	vector<array<double, 2>> ret(0);
+
+	// no ranges: the histogram is not streaming
+	if(obs_ranges.size() == 0)
+		return ret;
+
+	if(obs_ranges.size() != obs_bins.size())
+		throw runtime_error("A range must be specified for every observable " \
+			"or for none of them.");
+
+	ret.resize(obs_bins.size());
+	for(auto obs_range : obs_ranges)
+	{
+		ret[obs_range.first] = obs_range.second;
+	}
+
+	return ret;
+}
@@ -18,21 +18,187 @@
 
 #include <stdexcept>
 #include <cmath>
-#include <valarray>
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <exception>
+#include <vector>
+#include <array>
+#include <memory>
 
 #include <general/string_tools.h>
 #include <general/random_distributions/rng.h>
-#include <general/histogram_tools/counterindex.h>
 #include <general/histogram_tools/histogram.h>
+#include <general/histogram_tools/histogram_writer.h>
 #include <general/histogram_tools/bin_linear.h>
+#include <general/histogram_tools/sample_file.h>
 #include <general/simulator_tools/simulator_exceptions.h>
 
 #include "main-simulator.h"
 
 using namespace std;
 
+/**
+ * \brief The number of trials that use each substream of the random number
+ *    engine.
+ *
+ * Changing this value changes the simulated data for a given seed.
+ */
+constexpr size_t block_size{ 1024 };
+
+/**
+ * \brief The largest fraction of the binned trials that may fall outside the
+ *    range found by a pilot run without a warning.
+ */
+constexpr double pilot_outside_warning{ 0.001 };
+
+/**
+ * \brief Simulates trials and adds the observables to a histogram.
+ *
+ * The trials are divided into blocks of a fixed size, and block b uses
+ * substream b of the random number engine. The blocks in the range
+ * [first_block, end_block) are dealt out to the threads; each thread has its
+ * own partial histogram and count of trials that don't emit the observable,
+ * which are combined afterward. Because the random numbers for each trial do
+ * not depend on the thread that simulates it, the histogram is independent
+ * of the number of threads.
+ *
+ * If requested, the observables of every trial (and, optionally, the model
+ * parameters) are also given to a molstat::SampleWriter; its first row is
+ * the first trial of `first_block`.
+ *
+ * \throw std::exception if an error occurs in any thread.
+ *
+ * \param[in] sim The simulator.
+ * \param[in] engine_type The random number generator.
+ * \param[in] seed The seed for the random number engine.
+ * \param[in] ntrials The total number of trials (in all blocks).
+ * \param[in] first_block The first block to simulate.
+ * \param[in] end_block One past the last block to simulate.
+ * \param[in] threads The (maximum) number of threads.
+ * \param[in,out] hist The histogram; the trials are added to it.
+ * \param[in,out] samples The writer for the raw samples; `nullptr` if the
+ *    samples are not written.
+ * \param[in] parameters True if the model parameters are also given to
+ *    `samples`.
+ * \return The number of trials that did not produce an observable.
+ */
+static size_t simulateTrials(const molstat::Simulator &sim,
+	const molstat::EngineType engine_type, const uint64_t seed,
+	const size_t ntrials, const size_t first_block, const size_t end_block,
+	const size_t threads, molstat::Histogram &hist,
+	molstat::SampleWriter *samples = nullptr, const bool parameters = false)
+{
+	const size_t nblocks{ end_block - first_block };
+	const size_t nthreads{ min(threads, nblocks) };
+	vector<molstat::Histogram> partials(nthreads, hist);
+	vector<size_t> partial_no_obs(nthreads, 0);
+	vector<exception_ptr> errors(nthreads, nullptr);
+
+	auto worker = [&] (size_t thread) -> void
+	{
+		try
+		{
+			molstat::Engine engine{ engine_type, seed };
+
+			// the observables for a block are stored in one column per
+			// observable, followed by one column per model parameter (if
+			// requested)
+			const size_t nobs{ sim.numObservables() };
+			const size_t nparams{ parameters ? sim.numParameters() : 0 };
+			vector<double> columns((nobs + nparams) * block_size);
+			unique_ptr<bool[]> produced{ new bool[block_size] };
+
+			for(size_t block = first_block + thread; block < end_block;
+				block += nthreads)
+			{
+				const size_t n{ min(block_size, ntrials - block * block_size) };
+
+				engine.substream(block);
+				const size_t nproduced{ sim.simulateBatch(engine, n,
+					columns.data(), produced.get(),
+					nparams > 0 ? columns.data() + nobs * n : nullptr) };
+
+				// count the trials where one of the observables was not emitted
+				// for the randomly generated parameters
+				partial_no_obs[thread] += n - nproduced;
+
+				// add the trials that produced the observables
+				partials[thread].add_data(columns.data(), n, n, produced.get());
+
+				if(samples != nullptr)
+					samples->write((block - first_block) * block_size, n,
+						columns.data(), n);
+			}
+		}
+		catch(...)
+		{
+			errors[thread] = current_exception();
+		}
+	};
+
+	{
+		vector<thread> workers;
+		workers.reserve(nthreads);
+		for(size_t t = 0; t < nthreads; ++t)
+			workers.emplace_back(worker, t);
+
+		for(auto &t : workers)
+			t.join();
+	}
+
+	// combine the results from each thread
+	size_t no_obs { 0 };
+	for(size_t t = 0; t < nthreads; ++t)
+	{
+		if(errors[t] != nullptr)
+			rethrow_exception(errors[t]);
+
+		hist.merge(partials[t]);
+		no_obs += partial_no_obs[t];
+	}
+
+	return no_obs;
+}
+
+/**
+ * \brief Determines the histogram range from the data of a pilot run.
+ *
+ * The range of each dimension is the range of the pilot data, widened on
+ * each side by a fraction (the safety margin) of its width. The widening is
+ * done in the binning style's masked coordinates.
+ *
+ * \param[in] pilot The (unbinned) histogram of the pilot data.
+ * \param[in] bstyles The binning styles.
+ * \param[in] margin The safety margin.
+ * \return The range of each dimension, or an empty vector if the pilot
+ *    data does not determine a range (e.g., no data, or no spread in a
+ *    dimension).
+ */
+static vector<array<double, 2>> pilotRanges(const molstat::Histogram &pilot,
+	const vector<shared_ptr<const molstat::BinStyle>> &bstyles,
+	const double margin)
+{
+	vector<array<double, 2>> ret(bstyles.size());
+
+	for(size_t j = 0; j < bstyles.size(); ++j)
+	{
+		const array<double, 2> extremes{ pilot.getExtremes(j) };
+
+		const double lower{ bstyles[j]->mask(extremes[0]) };
+		const double upper{ bstyles[j]->mask(extremes[1]) };
+		const double width{ upper - lower };
+
+		if(!isfinite(lower) || !isfinite(upper) || !(width > 0.))
+			return {};
+
+		ret[j][0] = bstyles[j]->invmask(lower - margin * width);
+		ret[j][1] = bstyles[j]->invmask(upper + margin * width);
+	}
+
+	return ret;
+}
+
 /**
  * \brief Main function for simulating a histogram.
  *
@@ -69,13 +235,30 @@ int main(int argc, char **argv)
 
 	// need to finish processing input
 	// check the number of trials
-	const size_t ntrials{ parser.numTrials() };
-	if(ntrials == 0)
+	const size_t total_trials{ parser.numTrials() };
+	if(total_trials == 0)
 	{
 		cout << "FATAL ERROR: There must be at least one trial." << endl;
 		return 0;
 	}
 
+	// the blocks of trials simulated by this job; stream K of N simulates
+	// the K-th of N nearly equal, consecutive sets of blocks
+	const size_t total_blocks{ (total_trials + block_size - 1) / block_size };
+	const size_t first_block{ (parser.streamIndex() - 1) * total_blocks /
+		parser.numStreams() };
+	const size_t end_block{ parser.streamIndex() * total_blocks /
+		parser.numStreams() };
+	if(first_block == end_block)
+	{
+		cout << "FATAL ERROR: Stream " << parser.streamIndex() << " of " <<
+			parser.numStreams() << " has no trials. Use more trials or fewer " \
+			"streams." << endl;
+		return 0;
+	}
+	const size_t ntrials{ min(end_block * block_size, total_trials) -
+		first_block * block_size };
+
 	// create the simulator
 	// this will make sure model names are good, all distributions are
 	// specified, all observables are valid, etc.
@@ -90,8 +273,29 @@ int main(int argc, char **argv)
 		return 0;
 	}
 
-	// open the output file
-	ofstream histout(parser.outputFileName(), std::ios_base::app);
+	// the jobs of a split simulation can only be merged if they use the same
+	// range, so each job cannot use the range of its own trials
+	try
+	{
+		if(parser.numStreams() > 1 && parser.getRanges().size() == 0 &&
+			parser.pilotTrials() == 0)
+		{
+			cout << "FATAL ERROR: A simulation split with \"stream\" needs a " \
+				"range for every observable or a pilot run, so that the jobs' " \
+				"histograms can be merged." << endl;
+			return 0;
+		}
+	}
+	catch(const exception &e)
+	{
+		cout << "FATAL ERROR: " << e.what() << endl;
+		return 0;
+	}
+
+	// open the output file; a text histogram is appended to the file, but a
+	// binary histogram replaces it
+	ofstream histout(parser.outputFileName(), parser.binaryOutput() ?
+		std::ios_base::binary | std::ios_base::trunc : std::ios_base::app);
 	if(!histout)
 	{
 		cout << "FATAL ERROR: Unable to open \"" << parser.outputFileName() <<
@@ -102,10 +306,6 @@ int main(int argc, char **argv)
 	// print the simulator information
 	parser.printState(cout);
 
-	// initialize the random number engine
-	//molstat::Engine engine{ 0xFEEDFACE }; // use this line for debugging
-	molstat::Engine engine{ static_cast<unsigned int>(time(nullptr)) };
-
 	// create the histogram object
 	// first need the bin styles to determine the dimensionality
 	vector<shared_ptr<const molstat::BinStyle>> bstyles(0);
@@ -116,43 +316,170 @@ int main(int argc, char **argv)
 			bstyles[j] = nonconst[j];
 	} // this was necessary to add const to the pointer
 
-	molstat::Histogram hist(bstyles.size());
+	// if ranges were specified for the observables, the histogram is binned
+	// as the data is simulated (streaming); otherwise, all of the data is
+	// stored until the range is known
+	unique_ptr<molstat::Histogram> histptr{ nullptr };
+	try
+	{
+		const vector<array<double, 2>> ranges{ parser.getRanges() };
 
-	// Get the requested number of samples
-	// count the number of trials that don't emit the observable
-	size_t no_obs { 0 };
-	for (size_t j = 0; j < ntrials; ++j)
+		if(ranges.size() > 0)
+			histptr.reset(new molstat::Histogram(bstyles, ranges));
+		else
+			histptr.reset(new molstat::Histogram(bstyles.size()));
+	}
+	catch(const exception &e)
 	{
+		cout << "FATAL ERROR: " << e.what() << endl;
+		return 0;
+	}
+
+	// if requested (and no ranges were specified), a pilot run determines the
+	// range of the histogram
+	bool pilot_range{ false };
+	if(!histptr->isStreaming() && parser.pilotTrials() > 0)
+	{
+		// every stream uses the same pilot trials (the first ones), and thus
+		// the same range. the parameters of a block are drawn together (one
+		// parameter at a time), so a partial block would not reproduce the
+		// main simulation's trials; the pilot run uses whole blocks.
+		const size_t npilot{ min((parser.pilotTrials() + block_size - 1) /
+			block_size * block_size, total_trials) };
+
 		try
 		{
-			// add the data to the list
-			hist.add_data(sim->simulate(engine));
+			molstat::Histogram pilot(bstyles.size());
+			simulateTrials(*sim, parser.engineType(), parser.seed(), npilot, 0,
+				(npilot + block_size - 1) / block_size, parser.numThreads(),
+				pilot);
+
+			const vector<array<double, 2>> ranges{ pilotRanges(pilot, bstyles,
+				parser.pilotMargin()) };
+
+			if(ranges.size() > 0)
+			{
+				histptr.reset(new molstat::Histogram(bstyles, ranges));
+				pilot_range = true;
+
+				cout << "\nThe pilot run (" << npilot << " trials) set the " \
+					"histogram range to\n";
+				for(size_t j = 0; j < ranges.size(); ++j)
+					cout << "   Dimension " << j << ": [" << ranges[j][0] << ", " <<
+						ranges[j][1] << "]\n";
+			}
+			else if(parser.numStreams() > 1)
+			{
+				cout << "FATAL ERROR: The pilot run could not determine a " \
+					"histogram range, which a simulation split with \"stream\" " \
+					"needs." << endl;
+				return 0;
+			}
+			else
+				cout << "\nThe pilot run could not determine a histogram range; " \
+					"all of the data will be stored.\n";
 		}
-		catch(const molstat::NoObservableProduced &e)
+		catch(const exception &e)
 		{
-			// one of the observables was not emitted for the randomly generated
-			// parameters
-			++no_obs;
+			cout << "FATAL ERROR: " << e.what() << endl;
+			return 0;
 		}
 	}
+	molstat::Histogram &hist = *histptr;
+
+	// simulate the trials, writing the raw samples if requested
+	size_t no_obs { 0 };
+	try
+	{
+		unique_ptr<molstat::SampleWriter> samples{ nullptr };
+		if(parser.sampleFileName().size() > 0)
+		{
+			vector<string> names{ parser.getObservableNames() };
+			if(parser.sampleParameters())
+			{
+				const vector<string> params{ sim->parameterNames() };
+				names.insert(names.end(), params.begin(), params.end());
+			}
+
+			samples.reset(new molstat::SampleWriter(parser.sampleFileName(),
+				names, sim->numObservables(), ntrials));
+		}
+
+		if(parser.numStreams() > 1)
+		{
+			cout << "\nStream " << parser.streamIndex() << " of " <<
+				parser.numStreams() << " simulates trials " <<
+				first_block * block_size + 1 << " to " <<
+				first_block * block_size + ntrials << " of " << total_trials <<
+				".\n";
+		}
+
+		no_obs = simulateTrials(*sim, parser.engineType(), parser.seed(),
+			total_trials, first_block, end_block, parser.numThreads(), hist,
+			samples.get(), parser.sampleParameters());
+
+		if(samples != nullptr)
+		{
+			samples->close();
+			cout << "\nThe raw samples were written to " <<
+				parser.sampleFileName() << ".\n";
+		}
+	}
+	catch(const exception &e)
+	{
+		cout << "FATAL ERROR: " << e.what() << endl;
+		return 0;
+	}
 
 	// print out the number of trials that did not produce an observable
 	cout << '\n' << no_obs << " of the " << ntrials << " trials (" <<
-		(100. * no_obs / ntrials) << "%) did not produce an observable.\n" <<
-		(ntrials - no_obs) << " of the " << ntrials << " trials (" <<
-		(100. * (ntrials - no_obs) / ntrials) <<
+		(100. * no_obs / ntrials) << "%) did not produce an observable.\n";
+
+	// for a streaming histogram, also report the trials outside the range
+	size_t binned_trials{ ntrials - no_obs };
+	if(hist.isStreaming())
+	{
+		binned_trials -= hist.numOutside();
+
+		cout << hist.numOutside() << " of the " << ntrials << " trials (" <<
+			(100. * hist.numOutside() / ntrials) << "%) were outside the " \
+			"histogram range.\n";
+		for(size_t j = 0; j < bstyles.size(); ++j)
+		{
+			cout << "   Dimension " << j << ": " << hist.getUnderflow(j) <<
+				" underflow, " << hist.getOverflow(j) << " overflow.\n";
+		}
+
+		// the range from a pilot run may have been too narrow
+		if(pilot_range && hist.numOutside() >
+			pilot_outside_warning * (ntrials - no_obs))
+		{
+			cout << "WARNING: Many trials were outside the range found by the " \
+				"pilot run.\n   Consider more pilot trials, a larger safety " \
+				"margin, or an explicit range.\n";
+		}
+	}
+
+	cout << binned_trials << " of the " << ntrials << " trials (" <<
+		(100. * binned_trials / ntrials) <<
 		"%) were binned into a histogram." << endl;
 
 	// make the histogram
 	// if we encounter a bad dimension -- specifically, one where there is no
 	// range of data (all trials yield the same value) and more than one bin
-	// is specified -- override the binstyle for that dimension and try again
+	// is specified -- override the binstyle for that dimension and try again.
+	// a streaming histogram's bins were set up with its range
 	bool binned { false };
-	do
+	if(hist.isStreaming())
+	{
+		hist.bin_data();
+		binned = true;
+	}
+	while(!binned)
 	{
 		try
 		{
-			hist.bin_data(bstyles);
+			hist.bin_data(bstyles, parser.numThreads());
 			binned = true;
 		}
 		catch(const size_t &bad_dim)
@@ -163,17 +490,37 @@ int main(int argc, char **argv)
 				"more than 1 bin was requested.\nOnly using 1 bin." << endl;
 			bstyles[bad_dim] = make_shared<const molstat::BinLinear>(1);
 		}
-	} while(!binned);
+	}
 
-	// go through the bins
-	molstat::CounterIndex ci { hist.begin() };
+	// write the binary histogram
+	if(parser.binaryOutput())
+	{
+		try
+		{
+			hist.serialize(histout);
+		}
+		catch(const exception &e)
+		{
+			cout << "FATAL ERROR: " << e.what() << endl;
+		}
+
+		return 0;
+	}
+
+	// write the bins; a sparse histogram only has its occupied bins written
+	if(hist.isSparse())
+		cout << "The histogram has too many bins to store; only the occupied " \
+			"bins are output." << endl;
 
-	for(molstat::CounterIndex ci{ hist.begin() }; !ci.at_end(); ++ci)
+	try
+	{
+		molstat::HistogramWriter writer(histout, parser.exactOutput());
+		writer.write(hist);
+	}
+	catch(const exception &e)
 	{
-		const valarray<double> coords = hist.getCoordinates(ci);
-		for(size_t j = 0; j < coords.size(); ++j)
-			histout << coords[j] << ' ';
-		histout << hist.getBinCount(ci) << endl;
+		cout << "FATAL ERROR: " << e.what() << endl;
+		return 0;
 	}
 
 	// close the output stream
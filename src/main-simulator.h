@@ -21,6 +21,10 @@
 #include <queue>
 #include <list>
 #include <map>
+#include <array>
+#include <vector>
+#include <ctime>
+#include <cstdint>
 
 #include <general/simulator_tools/simulator.h>
 
@@ -77,12 +81,69 @@ private:
 	         std::pair<std::string, std::shared_ptr<molstat::BinStyle>>>
 		obs_bins;
 
+	/**
+	 * \brief Map of observable index (axis) to the (optional) range of the
+	 *    observable.
+	 *
+	 * If ranges are specified, the histogram is binned as the data is
+	 * simulated, instead of storing all of the data.
+	 */
+	std::map<std::size_t, std::array<double, 2>> obs_ranges;
+
 	/// File name for the histogram output.
 	std::string histfilename{ "histogram.dat" };
 
+	/**
+	 * \brief True if the histogram is written in the binary format (see
+	 *    molstat::Histogram::serialize()) instead of as text.
+	 */
+	bool binary_output{ false };
+
+	/**
+	 * \brief True if a text histogram is written with all the digits needed
+	 *    to reproduce each number (instead of 6 significant digits).
+	 */
+	bool exact_output{ false };
+
+	/**
+	 * \brief File name for the raw samples (see molstat::SampleWriter); empty
+	 *    if the samples are not written.
+	 */
+	std::string samplefilename;
+
+	/// True if the model parameters are written with the raw samples.
+	bool sample_parameters{ false };
+
 	/// The number of trials (i.e., data points to simulate).
 	std::size_t trials{ 0 };
 
+	/// The number of threads to use for simulating the trials.
+	std::size_t nthreads{ 1 };
+
+	/**
+	 * \brief The number of pilot trials used to determine the histogram
+	 *    range; 0 if there is no pilot run.
+	 */
+	std::size_t npilot{ 0 };
+
+	/**
+	 * \brief The safety margin added to each side of the range found by the
+	 *    pilot run, as a fraction of the range (in binned coordinates).
+	 */
+	double pilot_margin{ 0.1 };
+
+	/// The seed for the random number engine; defaults to the current time.
+	std::uint64_t rngseed{ static_cast<std::uint64_t>(time(nullptr)) };
+
+	/// The random number generator; defaults to Philox.
+	molstat::EngineType rngtype{ molstat::EngineType::Philox };
+
+	/// The number of streams (jobs) the trials are divided among.
+	std::size_t nstreams{ 1 };
+
+	/// The stream (job) simulated by this run, from 1 to nstreams.
+	std::size_t stream_index{ 1 };
+
 	/**
 	 * \brief Prints an error message.
 	 *
@@ -163,6 +224,56 @@ public:
 	 */
 	std::size_t numTrials() const noexcept;
 
+	/**
+	 * \brief Gets the number of threads.
+	 *
+	 * \return The number of threads.
+	 */
+	std::size_t numThreads() const noexcept;
+
+	/**
+	 * \brief Gets the seed for the random number engine.
+	 *
+	 * \return The seed.
+	 */
+	std::uint64_t seed() const noexcept;
+
+	/**
+	 * \brief Gets the random number generator.
+	 *
+	 * \return The generator.
+	 */
+	molstat::EngineType engineType() const noexcept;
+
+	/**
+	 * \brief Gets the number of streams (jobs) the trials are divided
+	 *    among.
+	 *
+	 * \return The number of streams; 1 if the trials are not divided.
+	 */
+	std::size_t numStreams() const noexcept;
+
+	/**
+	 * \brief Gets the stream (job) simulated by this run.
+	 *
+	 * \return The stream, from 1 to numStreams().
+	 */
+	std::size_t streamIndex() const noexcept;
+
+	/**
+	 * \brief Gets the number of pilot trials.
+	 *
+	 * \return The number of pilot trials; 0 if there is no pilot run.
+	 */
+	std::size_t pilotTrials() const noexcept;
+
+	/**
+	 * \brief Gets the safety margin for the range found by the pilot run.
+	 *
+	 * \return The margin, as a fraction of the range.
+	 */
+	double pilotMargin() const noexcept;
+
 	/**
 	 * \brief Prints the state of the input parser.
 	 *
@@ -179,12 +290,60 @@ public:
 	 */
 	std::string outputFileName() const;
 
+	/**
+	 * \brief Determines if the histogram is written in the binary format.
+	 *
+	 * \return True for the binary format, false for text.
+	 */
+	bool binaryOutput() const noexcept;
+
+	/**
+	 * \brief Determines if a text histogram is written with all the digits
+	 *    needed to reproduce each number.
+	 *
+	 * \return True for exact text output.
+	 */
+	bool exactOutput() const noexcept;
+
+	/**
+	 * \brief Returns the name of the file for the raw samples.
+	 *
+	 * \return The name of the file; empty if the samples are not written.
+	 */
+	std::string sampleFileName() const;
+
+	/**
+	 * \brief Determines if the model parameters are written with the raw
+	 *    samples.
+	 *
+	 * \return True if the model parameters are written.
+	 */
+	bool sampleParameters() const noexcept;
+
+	/**
+	 * \brief Get the names of the observables.
+	 *
+	 * \return A vector containing the name of each observable.
+	 */
+	std::vector<std::string> getObservableNames() const;
+
 	/**
 	 * \brief Get the binning styles.
 	 *
 	 * \return A vector containing the binning styles.
 	 */
 	std::vector<std::shared_ptr<molstat::BinStyle>> getBinStyles() const;
+
+	/**
+	 * \brief Get the ranges of the observables.
+	 *
+	 * \throw std::runtime_error if some, but not all, observables have a
+	 *    range.
+	 *
+	 * \return A vector containing the range (minimum and maximum) of each
+	 *    observable, or an empty vector if no ranges were specified.
+	 */
+	std::vector<std::array<double, 2>> getRanges() const;
 };
 
 #endif
@@ -0,0 +1,82 @@
+# This file is a part of MolStat, which is distributed under the Creative
+# Commons Attribution-NonCommercial 4.0 International Public License.
+#
+# (c) 2014 Northwestern University
+
+##
+ # @file tests/simulator-histmerge.py
+ # @brief Simulate two binary histograms and sum them with molstat-histmerge.
+ #
+ # @test Test suite for the histogram merge program.
+
+import subprocess
+import os
+import math
+
+## @cond
+
+# runtime variables
+trials = 100000
+bins = 10
+minval = -2.
+maxval = 2.
+shards = ['shard1.bin', 'shard2.bin']
+
+# simulate each shard with a different seed and the same range
+for j in range(len(shards)):
+	process = subprocess.Popen('../molstat-simulator', \
+		stdout=subprocess.PIPE, \
+		stdin=subprocess.PIPE, \
+		stderr=subprocess.PIPE)
+	output = process.communicate( \
+	'observable Identity ' + str(bins) + ' linear range ' + str(minval) + \
+		' ' + str(maxval) + '\n' \
+	'model IdentityModel\n' \
+	'	distribution parameter uniform ' + str(minval) + ' ' + str(maxval) + \
+		'\n' \
+	'endmodel\n' \
+	'trials ' + str(trials) + '\n' \
+	'seed ' + str(j + 1) + '\n' \
+	'format binary\n' \
+	'output ' + shards[j])
+
+# read a text histogram into a list of [x, count]
+def readText(filename):
+	ret = []
+	hist = open(filename, 'r')
+	for bin in hist:
+		tokens = str.split(bin)
+		assert(len(tokens) == 2)
+		ret.append([float(tokens[0]), float(tokens[1])])
+	hist.close()
+	os.remove(filename)
+	return ret
+
+# convert each shard to text, and sum them
+texts = []
+for j in range(len(shards)):
+	subprocess.call(['../molstat-histmerge', '-t', 'shard.txt', shards[j]])
+	texts.append(readText('shard.txt'))
+
+subprocess.call(['../molstat-histmerge', '-t', 'sum.txt'] + shards)
+total = readText('sum.txt')
+
+# the sum can also be written in the binary format
+subprocess.call(['../molstat-histmerge', 'sum.bin'] + shards)
+subprocess.call(['../molstat-histmerge', '-t', 'sum.txt', 'sum.bin'])
+assert(readText('sum.txt') == total)
+
+for filename in shards + ['sum.bin']:
+	os.remove(filename)
+
+# check the sum
+assert(len(total) == bins)
+for j in range(bins):
+	expected = texts[0][j][1] + texts[1][j][1]
+	print "Expected: " + str(expected) + ", Actual: " + str(total[j][1])
+	assert(total[j][0] == texts[0][j][0])
+	assert(math.fabs(total[j][1] - expected) < 1.e-5 * expected)
+	assert(math.fabs(total[j][1] - 2. * trials / bins) < \
+		2.e-2 * 2. * trials / bins)
+
+## @endcond
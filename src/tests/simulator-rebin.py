@@ -0,0 +1,96 @@
+# This file is a part of MolStat, which is distributed under the Creative
+# Commons Attribution-NonCommercial 4.0 International Public License.
+#
+# (c) 2014 Northwestern University
+
+##
+ # @file tests/simulator-rebin.py
+ # @brief Simulate a histogram while writing the raw samples, and re-bin the
+ #    samples with molstat-rebin.
+ #
+ # @test Test suite for the sample files and the re-binning program.
+
+import subprocess
+import os
+import math
+
+## @cond
+
+# runtime variables
+trials = 100000
+bins = 20
+minval = 1.
+maxval = 3.
+
+# simulate a histogram, keeping the samples and the model parameter
+process = subprocess.Popen('../molstat-simulator', \
+	stdout=subprocess.PIPE, \
+	stdin=subprocess.PIPE, \
+	stderr=subprocess.PIPE)
+output = process.communicate( \
+'observable Identity ' + str(bins) + ' log 10\n' \
+'model IdentityModel\n' \
+'	distribution parameter uniform ' + str(minval) + ' ' + str(maxval) + \
+	'\n' \
+'endmodel\n' \
+'trials ' + str(trials) + '\n' \
+'threads 3\n' \
+'format exact\n' \
+'samples rebin.samples parameters\n' \
+'output simulated.txt')
+
+# re-bin the samples: the same histogram, a histogram of the parameter with a
+# range, and a 2D histogram
+process = subprocess.Popen('../molstat-rebin', \
+	stdout=subprocess.PIPE, \
+	stdin=subprocess.PIPE, \
+	stderr=subprocess.PIPE)
+output = process.communicate( \
+'samples rebin.samples\n' \
+'threads 2\n' \
+'histogram same.txt exact\n' \
+'	column identity ' + str(bins) + ' log 10\n' \
+'endhistogram\n' \
+'histogram param.txt\n' \
+'	column parameter 4 linear range 1 2\n' \
+'endhistogram\n' \
+'histogram both.txt\n' \
+'	column identity 5 linear\n' \
+'	column parameter 3 linear\n' \
+'endhistogram\n')
+print output[0]
+
+# read a text histogram into a list of lists of numbers
+def readText(filename):
+	ret = []
+	hist = open(filename, 'r')
+	for bin in hist:
+		ret.append([float(x) for x in str.split(bin)])
+	hist.close()
+	os.remove(filename)
+	return ret
+
+# the re-binned histogram is the simulated histogram
+simulated = readText('simulated.txt')
+same = readText('same.txt')
+assert(len(simulated) == bins)
+assert(same == simulated)
+
+# the parameter is the observable, so half of the trials are in [1, 2]
+param = readText('param.txt')
+assert(len(param) == 4)
+for j in range(4):
+	print "Expected: " + str(trials / 8.) + ", Actual: " + str(param[j][1])
+	assert(math.fabs(param[j][1] - trials / 8.) < 0.05 * trials / 8.)
+
+# the 2D histogram is diagonal
+both = readText('both.txt')
+assert(len(both) == 15)
+total = 0.
+for b in both:
+	total += b[2]
+assert(math.fabs(total - trials) < 1.e-6 * trials)
+
+os.remove('rebin.samples')
+
+## @endcond
@@ -0,0 +1,116 @@
+# This file is a part of MolStat, which is distributed under the Creative
+# Commons Attribution-NonCommercial 4.0 International Public License.
+#
+# (c) 2014 Northwestern University
+
+##
+ # @file tests/simulator-streams.py
+ # @brief Split a simulation into several jobs with the stream command, and
+ #    make sure the merged histogram is that of a single run.
+ #
+ # @test Test suite for the stream command and the jump-ahead substreams.
+
+import subprocess
+import os
+
+## @cond
+
+# runtime variables; the number of trials is not a multiple of the block size
+trials = 50000
+bins = 20
+njobs = 3
+
+# simulate the trials (all of them, or stream k of n) with an engine. by
+# default, the observable has a range; otherwise, the deck may request a pilot
+# run
+def simulate(engine, outfile, stream, obsrange = ' range -3 3', pilot = ''):
+	deck = 'observable Identity ' + str(bins) + ' linear' + obsrange + '\n' \
+		'model IdentityModel\n' \
+		'	distribution parameter normal 0 1\n' \
+		'endmodel\n' \
+		'trials ' + str(trials) + '\n' \
+		'seed 2014\n' \
+		'threads 2\n' \
+		'engine ' + engine + '\n' \
+		'format binary\n' \
+		'output ' + outfile + '\n'
+	if stream != '':
+		deck += 'stream ' + stream + '\n'
+	if pilot != '':
+		deck += 'pilot ' + pilot + '\n'
+
+	process = subprocess.Popen('../molstat-simulator', \
+		stdout=subprocess.PIPE, \
+		stdin=subprocess.PIPE, \
+		stderr=subprocess.PIPE)
+	output = process.communicate(deck)
+	assert(output[0].find('FATAL ERROR') == -1)
+
+# convert a binary histogram to exact text, as a list of lines
+def readHistogram(filenames):
+	subprocess.call(['../molstat-histmerge', '-e', 'streams.txt'] + filenames)
+	hist = open('streams.txt', 'r')
+	ret = hist.readlines()
+	hist.close()
+	os.remove('streams.txt')
+	for filename in filenames:
+		os.remove(filename)
+	return ret
+
+for engine in ['philox', 'mt19937_64', 'xoshiro256++', 'pcg64']:
+	print engine
+
+	simulate(engine, 'single.bin', '')
+	single = readHistogram(['single.bin'])
+
+	jobs = []
+	for k in range(njobs):
+		jobs.append('job' + str(k + 1) + '.bin')
+		simulate(engine, jobs[k], str(k + 1) + ' of ' + str(njobs))
+	merged = readHistogram(jobs)
+
+	assert(len(single) == bins)
+	assert(merged == single)
+
+# without a range, every job would use the range of its own trials; a pilot
+# run (the same trials for every job) gives all of them the same range
+simulate('philox', 'single.bin', '', '', '2000')
+single = readHistogram(['single.bin'])
+
+jobs = []
+for k in range(njobs):
+	jobs.append('job' + str(k + 1) + '.bin')
+	simulate('philox', jobs[k], str(k + 1) + ' of ' + str(njobs), '', '2000')
+merged = readHistogram(jobs)
+
+assert(len(single) == bins)
+assert(merged == single)
+
+# with neither a range nor a pilot run, the jobs could not be merged
+process = subprocess.Popen('../molstat-simulator', \
+	stdout=subprocess.PIPE, \
+	stdin=subprocess.PIPE, \
+	stderr=subprocess.PIPE)
+output = process.communicate('observable Identity ' + str(bins) + \
+	' linear\n' \
+	'model IdentityModel\n' \
+	'	distribution parameter normal 0 1\n' \
+	'endmodel\n' \
+	'trials ' + str(trials) + '\n' \
+	'output streams.dat\n' \
+	'stream 1 of 2\n')
+assert(output[0].find('FATAL ERROR: A simulation split with "stream" needs') \
+	!= -1)
+assert(not os.path.exists('streams.dat'))
+
+# stream errors
+process = subprocess.Popen('../molstat-simulator', \
+	stdout=subprocess.PIPE, \
+	stdin=subprocess.PIPE, \
+	stderr=subprocess.PIPE)
+output = process.communicate('stream 4 of 3\nstream 1 3\n')
+print output[0]
+assert(output[0].find('Error on line  1: The stream must be from 1') != -1)
+assert(output[0].find('Error on line  2: Use "stream K of N"') != -1)
+
+## @endcond